@@ -26,11 +26,22 @@
 #include <stdlib.h>
 #include <math.h>
 #include <time.h>
+#include <string.h>
+#include <unistd.h>
+#include <sched.h>
+#include <pthread.h>
 #include <sys/time.h>
+#include <sys/stat.h>
+#include <sys/mman.h>
+#include <fcntl.h>
+#include <signal.h>
+#include <dirent.h>
+#include "FollowMe.h"
 
 #define OPTIMIZATION //Comment this line to remove every optimization
 //#define ANIMATION
 //#define RANDOM_COLOR
+//#define STATISTICS //Counts the nodes, the prunes and the time of the search, printed with the option -s
 
 /* 
 *  Data.dat file format
@@ -41,18 +52,25 @@
 *  the first number is x_start, the second y_start, the third x_end, the forth y_end.
 *  each line represents the two endpoints of the path.
 */
-struct _Cell { //This is one cell of the game grid
+struct _Cell { //This is one cell of the game grid, it takes only two bytes so the whole grid stays in the cache
     //Each cell can be part of a path or a void cell or a external cell (this option does not exist in the game)
-    long unsigned Path: (sizeof(long unsigned) << 3) - 1; //ID of the path, starting from 1, 0 is a special value
+    unsigned char Path; //ID of the path, starting from 1, 0 is a special value
     //if this ID is 1 means that the cell is part of the path that joins the first couple of points,
     //if it is 2 means that the cell is patrt of the path that joins the second couple of points, etc.
     //0 is the only special value, it means that the cell does not be part of any path
-    long unsigned Joined: 1; //one bit, if it is 1 the piece of the path is joined to the end, otherwise not
-    long unsigned ID; //ID of the piece in the path, so if it is 0 it represents the start endpoint, if it is ULONG_MAX
-    //it represents the end endpoint, if it is 1 represents the first piece of the path, 2 the second, etc.
-    //if Path is 0, ID does not represents anything, it olny means that the cell is not part of any path.
+    unsigned char Links: 4; //one bit for each adjacent cell (see DIR_LEFT...), it is 1 if the piece of the path
+    //in that cell comes before or after this one, so a piece of the path has two links and an endpoint has one
+    //when the path is complete. There is no need to store the order of the pieces, the sequence can be
+    //rebuilt following the links from the start endpoint.
+    unsigned char Endpoint: 1; //1 if the cell is one of the endpoints of the path
+    unsigned char End: 1; //1 if the cell is the tail of the path, the end endpoint if it was not extended from there
 };
-#define ULONG_MAX (~(long unsigned)0) //The maximum value can a long unsigned contains
+#define MAX_PATHS 255 //The ID of the path must fit in Path
+
+#define DIR_LEFT  0x1 //x - 1
+#define DIR_RIGHT 0x2 //x + 1
+#define DIR_UP    0x4 //y - 1
+#define DIR_DOWN  0x8 //y + 1
 
 struct _PathPoint { //Struct that represents the endpoints of a path
     unsigned x_start; //x coordinate of the start endpoint
@@ -64,12 +82,25 @@ struct _PathPoint { //Struct that represents the endpoints of a path
 typedef struct _Cell Cell;
 typedef struct _PathPoint PathPoint;
 
-Cell *GameGrid;
-PathPoint *Points;
-int Width, Height;
-int Points_Len;
-unsigned char *FloodFillData;
-int FloodFillData_Len;
+//The grid and the buffers used by the search are private to each thread, so when the game is solved
+//with more threads every worker has its own copy of them. The game is private too, so in batch mode
+//each thread can solve a different one, the workers of a parallel search copy it (see GameData).
+__thread Cell *GameGrid;
+__thread int *Heads; //Cell where each path goes on (its start endpoint if it is not started yet), -1 if it was joined
+__thread int *Tails; //The same from the other endpoint, the cell the head must be joined to (see Bidirectional search)
+__thread int Unfinished; //Number of paths not joined yet
+__thread int *PathLevel; //Level of the split of the regions at which each path is extended (see Independent regions)
+__thread int SplitLevel = 0; //Level of the search running, only the paths of this level are extended
+__thread int UnfinishedGoal = 0; //The search running ends when Unfinished gets here, 0 for the whole game
+#define StackLen (Width*Height + 2*Points_Len + 1) //Nodes of the deepest branch of the search
+__thread PathPoint *Points;
+__thread int Width, Height;
+__thread int Points_Len;
+#define MAX_SYMMETRIES 8
+__thread struct _Symmetry *Symmetries; //Rotations and reflections which map the game on itself, the first one is the identity
+__thread int Symmetries_Len;
+__thread int SymmetryRoots[MAX_SYMMETRIES]; //The endpoints extended first, an orbit of the symmetries (see Symmetries)
+__thread int SymmetryDepth; //Number of SymmetryRoots, 0 if the game has no symmetries
 /*
 __inline__ rol(long unsigned op, unsigned bits){
     __asm__ __volatile__("rol %%cl, %%eax"
@@ -88,21 +119,29 @@ __inline__ ror(long unsigned op, unsigned bits){
 #define GET_N_BIT(num, pos) ((num & (1 << pos))?(1):(0))
 #define SET_N_BIT(num, pos, new_val) ((new_val)?((num) |= (0x01 << pos)):((num) &= (~(0x1 << pos))))
 
-#define GET_FLOOD_FILL_DATA(x, y) GET_N_BIT(FloodFillData[(((unsigned)(x) % Width) + ((unsigned)(y) % Height)*Width) >> 3], \
-((((unsigned)(x) % Width) + ((unsigned)(y) % Height)*Width) & 0x7))
-#define SET_FLOOD_FILL_DATA(x, y, new_val) SET_N_BIT(FloodFillData[(((unsigned)(x) % Width) + ((unsigned)(y) % Height)*Width) >> 3],  \
-((((unsigned)(x) % Width) + ((unsigned)(y) % Height)*Width) & 0x07), \
-(new_val))
 int PrintPoint_x, PrintPoint_y;
-unsigned long long int TriedOutPaths = 0;
+pthread_mutex_t PrintLock = PTHREAD_MUTEX_INITIALIZER; //Only one thread at a time can draw on the screen
+__thread int Draw = 1; //0 if the grid is not drawn, as in batch mode
+__thread unsigned long long int TriedOutPaths = 0;
+__thread unsigned long long int CutOffPaths = 0; //Paths that were not tried out because they can't lead to a solution
 #define GameCell(x, y) GameGrid[((unsigned)(x) % Width) + ((unsigned)(y) % Height)*Width]
-#define IsEmpty(c)     (!((c).Path | (c).ID))
-#define IsNotEmpty(c)  ( ((c).Path | (c).ID))
+#define IsEmpty(c)     (!(c).Path)
+#define IsNotEmpty(c)  ((c).Path)
+
+/*
+*  Neighbours
+*  The checks of the search look at the 4 cells next to a cell. Instead of finding its column and its row with a
+*  division and checking the borders each time, Neighbours[4*cell + i] is the cell reached with the move i (see MoveX),
+*  computed once for the game. A move out of the grid reaches Sentinel, one more cell after the last one of GameGrid
+*  which is never empty, never a head or a tail and has no region, so it fails every check like a border does. Every
+*  move from the Sentinel reaches it again, so the cells on the diagonals are two moves away too.
+*/
+__thread int *Neighbours;
+#define Neighbour(cell, i) Neighbours[4*(cell) + (i)]
+#define Sentinel (Width*Height)
 //Otptimized, but unsafe
 // #define GetCell(x, y) GameGrid[(x), (y)*Height]
 
-#define Color_Reset printf("\033[0m")
-
 #ifdef RANDOM_COLOR
 int Randm = 25, Randq = 28;
 int Random(int Srand){
@@ -122,658 +161,3890 @@ int Random(int Srand){
     //probability : MAX = x : 256
     return probability;
 }
-#endif
 
-void TxColor(int N){
-#ifdef RANDOM_COLOR
-    printf("\033[38;5;%dm", Random(N));
+int PathColors[MAX_PATHS + 1]; //Colour of each path, Random is too slow to call it for each cell drawn
+
+void InitColors(){
+    int p;
+    for (p = 0; p <= MAX_PATHS; p++)
+        PathColors[p] = Random(p);
+}
+#define PathColor(p) PathColors[p]
 #else
-    printf("\033[38;5;%dm", N);
+#define PathColor(p) (p)
 #endif
+
+/*
+*  Drawing
+*  The grid is drawn in a frame buffer allocated once, with the escape sequences that move the cursor and change the
+*  colours, and then the frame is written out with a single call, so drawing a solution costs one write instead of
+*  hundreds of small printf. Each thread that draws has its own buffer.
+*/
+__thread char *FrameBuffer = NULL;
+
+#define FrameSize ((Height*2 + 1)*(Width*48 + 32) + 32) //At most 48 bytes for each cell and 32 for the cursor on each line
+
+void AllocFrame(){
+    if ((FrameBuffer = malloc(FrameSize)) == NULL){
+        fprintf(stderr, "Error allocating memory\n");
+        abort();
+    }
 }
 
-void BkColor(int N){
-#ifdef RANDOM_COLOR
-    printf("\033[48;5;%dm", Random(N));
-#else
-    printf("\033[48;5;%dm", N);
-#endif
+void FreeFrame(){
+    free(FrameBuffer);
+    FrameBuffer = NULL;
+}
+
+static inline char *PutText(char *out, const char *s){
+    while (*s)
+        *out++ = *s++;
+    return out;
+}
+
+static inline char *PutNumber(char *out, unsigned n){
+    char digits[10];
+    int i = 0;
+    do {
+        digits[i++] = '0' + n % 10;
+    } while (n /= 10);
+    while (i > 0)
+        *out++ = digits[--i];
+    return out;
 }
 
-void PrintGrid(){
+static inline char *PutCursor(char *out, int y, int x){ //Moves the cursor to the line y, column x
+    out = PutText(out, "\033[");
+    out = PutNumber(out, y);
+    *out++ = ';';
+    out = PutNumber(out, x);
+    *out++ = 'H';
+    return out;
+}
+
+static inline char *PutColor(char *out, int background, int path){
+    out = PutText(out, background?("\033[48;5;"):("\033[38;5;"));
+    out = PutNumber(out, PathColor(path));
+    *out++ = 'm';
+    return out;
+}
+
+#define PutReset(out) PutText(out, "\033[0m")
+
+int RenderGrid(const Cell *grid, int print_x, int print_y){ //Draws the grid in FrameBuffer with its upper left corner in print_x, print_y, returns the length
     int x, y,  // x and y coordinate
     x_end = Width*2 -1,
     y_end = Height*2-1,
-    print_x = PrintPoint_x+1, //x and y coordinates of the print point
-    print_y = PrintPoint_y+1,
     tmpx, tmpy;
     Cell ccell; //Current Cell
-    char samepath;
-    printf("\033[%d;%dH", print_y++, print_x); //Move the cursor to 0; 0
-    for (x = 0; x < Width; x++){
-        printf("+---");
-    }
-    printf("+\033[%d;%dH", print_y++, print_x);
+    char *out = FrameBuffer;
+    out = PutCursor(out, print_y + 1, print_x + 1);
+    for (x = 0; x < Width; x++)
+        out = PutText(out, "+---");
+    *out++ = '+';
+    out = PutCursor(out, print_y + 2, print_x + 1);
     for (y = 0; y < y_end; y++){
         tmpy = y >> 1;
         if (y % 2){
             for (x = 0; x < Width; x++){
-                if ((GameCell(x, tmpy).Path == GameCell(x, tmpy + 1).Path) &&
-                ((GameCell(x, tmpy).ID == (GameCell(x, tmpy + 1).ID + 1)) ||
-                ((GameCell(x, tmpy).ID + 1) == GameCell(x, tmpy + 1).ID) ||
-                ((GameCell(x, tmpy).ID == ULONG_MAX) && (GameCell(x, tmpy + 1).Joined)) ||
-                ((GameCell(x, tmpy + 1).ID == ULONG_MAX) && (GameCell(x, tmpy).Joined)))){
-                    printf("+-");
-                    TxColor(GameCell(x, tmpy).Path);
+                if (grid[x + tmpy*Width].Links & DIR_DOWN){
                     //Between two cells of the same path, so join them with their colour
-                    printf("|");
-                    Color_Reset;
-                    printf("-");
+                    out = PutText(out, "+-");
+                    out = PutColor(out, 0, grid[x + tmpy*Width].Path);
+                    *out++ = '|';
+                    out = PutReset(out);
+                    *out++ = '-';
                 } else {
-                    Color_Reset;
-                    printf("+---");
+                    out = PutReset(out);
+                    out = PutText(out, "+---");
                 }
             }
-            printf("+\033[%d;%dH", print_y++, print_x);
+            *out++ = '+';
         } else {
-            printf("|");
+            *out++ = '|';
             for (x = 0; x < x_end; x++){
                 tmpx = x >> 1;
-                if (x % 2) {
-                    if ((GameCell(tmpx, tmpy).Path == GameCell(tmpx + 1, tmpy).Path) &&
-                    ((GameCell(tmpx, tmpy).ID == (GameCell(tmpx + 1, tmpy).ID + 1)) ||
-                    ((GameCell(tmpx, tmpy).ID + 1) == GameCell(tmpx + 1, tmpy).ID) ||
-                    ((GameCell(tmpx, tmpy).ID == ULONG_MAX) && (GameCell(tmpx + 1, tmpy).Joined)) ||
-                    ((GameCell(tmpx + 1, tmpy).ID == ULONG_MAX) && (GameCell(tmpx, tmpy).Joined)))){
-                        TxColor(GameCell(x >> 1, y >> 1).Path);
+                ccell = grid[tmpx + tmpy*Width];
+                if (x % 2){
+                    if (ccell.Links & DIR_RIGHT){
                         //Between two cells of the same path, so join them with their colour
-                        printf("-");
-                        Color_Reset;
+                        out = PutColor(out, 0, ccell.Path);
+                        *out++ = '-';
+                        out = PutReset(out);
                     } else {
-                        Color_Reset;
-                        printf("|");
+                        out = PutReset(out);
+                        *out++ = '|';
                     }
-                } else {
-                    if (GameCell(tmpx, tmpy).Path != 0){
-                        if (GameCell(tmpx, tmpy).ID == 0) {
-                            //The cell contains the start or the end of a path
-                            samepath = 0;
-                            ccell = GameCell(tmpx, tmpy);
-                            //Left cell
-                            if (((tmpx > 0) && (GameCell(tmpx -1, tmpy).Path == ccell.Path)) && (GameCell(tmpx - 1, tmpy).ID == 1))
-                                    samepath |= 0x1;
-                            //Right cell
-                            if (((tmpx + 1 < Width) && (GameCell(tmpx + 1, tmpy).Path == ccell.Path)) && (GameCell(tmpx + 1, tmpy).ID == 1))
-                                    samepath |= 0x2;
-                            //Above cell
-                            if (((tmpy > 0) && (GameCell(tmpx, tmpy - 1).Path == ccell.Path)) && (GameCell(tmpx, tmpy - 1).ID == 1))
-                                    samepath |= 0x4;
-                            //Below cell
-                            if (((tmpy + 1 < Height) && (GameCell(tmpx, tmpy + 1).Path == ccell.Path)) && (GameCell(tmpx, tmpy + 1).ID == 1))
-                                    samepath |= 0x8;
-                            //The cells arround the current that are in the same path are stored in samepath
-                            //There are 5 possibilities: none (0), only left (0x1), only right (0x2), only above (0x4), only below(0x8)
-                            switch(samepath){
-                                case 0x0: // None
-                                    printf(" ");
-                                    BkColor(ccell.Path);
-                                    printf(" ");
-                                    Color_Reset;
-                                    printf(" ");
-                                    break;
-                                case 0x1: // Left
-                                    TxColor(ccell.Path);
-                                    printf("-");
-                                    Color_Reset;
-                                    BkColor(ccell.Path);
-                                    printf(" ");
-                                    Color_Reset;
-                                    printf(" ");
-                                    break;
-                                case 0x2: // Right
-                                    printf(" ");
-                                    BkColor(ccell.Path);
-                                    printf(" ");
-                                    Color_Reset;
-                                    TxColor(ccell.Path);
-                                    printf("-");
-                                    Color_Reset;
-                                    break;
-                                case 0x4: // Above
-                                    printf(" ");
-                                    BkColor(ccell.Path);
-                                    printf(" ");
-                                    Color_Reset;
-                                    printf(" ");
-                                    break;
-                                case 0x8: // Below
-                                    printf(" ");
-                                    BkColor(ccell.Path);
-                                    printf(" ");
-                                    Color_Reset;
-                                    printf(" ");
-                                    break;
-                                default:
-                                    fprintf(stderr, "Error drawing the grid\n");
-                                    return;
-                            }
-                        } else if (GameCell(tmpx, tmpy).ID == ULONG_MAX) {
-                            samepath = 0;
-                            ccell = GameCell(tmpx, tmpy);
-                            //Left cell
-                            if (((tmpx > 0) && (GameCell(tmpx -1, tmpy).Path == ccell.Path)) && (GameCell(tmpx - 1, tmpy).Joined))
-                                    samepath |= 0x1;
-                            //Right cell
-                            if (((tmpx + 1 < Width) && (GameCell(tmpx + 1, tmpy).Path == ccell.Path)) && (GameCell(tmpx + 1, tmpy).Joined))
-                                    samepath |= 0x2;
-                            //Above cell
-                            if (((tmpy > 0) && (GameCell(tmpx, tmpy - 1).Path == ccell.Path)) && (GameCell(tmpx, tmpy - 1).Joined))
-                                    samepath |= 0x4;
-                            //Below cell
-                            if (((tmpy + 1 < Height) && (GameCell(tmpx, tmpy + 1).Path == ccell.Path)) && (GameCell(tmpx, tmpy + 1).Joined))
-                                    samepath |= 0x8;
-                            //The cells arround the current that are in the same path are stored in samepath
-                            //There are 5 possibilities: none (0), only left (0x1), only right (0x2), only above (0x4), only below(0x8)
-                            switch(samepath){
-                                case 0x0: // None
-                                    printf(" ");
-                                    BkColor(ccell.Path);
-                                    printf(" ");
-                                    Color_Reset;
-                                    printf(" ");
-                                    break;
-                                case 0x1: // Left
-                                    TxColor(ccell.Path);
-                                    printf("-");
-                                    Color_Reset;
-                                    BkColor(ccell.Path);
-                                    printf(" ");
-                                    Color_Reset;
-                                    printf(" ");
-                                    break;
-                                case 0x2: // Right
-                                    printf(" ");
-                                    BkColor(ccell.Path);
-                                    printf(" ");
-                                    Color_Reset;
-                                    TxColor(ccell.Path);
-                                    printf("-");
-                                    Color_Reset;
-                                    break;
-                                case 0x4: // Above
-                                    printf(" ");
-                                    BkColor(ccell.Path);
-                                    printf(" ");
-                                    Color_Reset;
-                                    printf(" ");
-                                    break;
-                                case 0x8: // Below
-                                    printf(" ");
-                                    BkColor(ccell.Path);
-                                    printf(" ");
-                                    Color_Reset;
-                                    printf(" ");
-                                    break;
-                                default:
-                                    fprintf(stderr, "Error drawing the grid\n");
-                                    return;
-                            }
-                        } else { //Cell is part of a path
-                            samepath = 0; //Samepath is used to store wich of the adiacent cells are part
-                            //of the same path of the current cell
-                            ccell = GameCell(tmpx, tmpy);
-                            //Left cell
-                            if ((tmpx > 0) && (GameCell(tmpx -1, tmpy).Path == ccell.Path))
-                                if ((GameCell(tmpx - 1, tmpy).ID == ccell.ID + 1) ||
-                                (GameCell(tmpx - 1, tmpy).ID + 1 == ccell.ID) ||
-                                ((GameCell(tmpx -1, tmpy).ID == ULONG_MAX) && (ccell.Joined)))
-                                    samepath |= 0x1;
-                            //Right cell
-                            if ((tmpx + 1 < Width) && (GameCell(tmpx + 1, tmpy).Path == ccell.Path))
-                                if ((GameCell(tmpx + 1, tmpy).ID == ccell.ID + 1) ||
-                                (GameCell(tmpx + 1, tmpy).ID + 1 == ccell.ID) ||
-                                ((GameCell(tmpx +1, tmpy).ID == ULONG_MAX) && (ccell.Joined)))
-                                    samepath |= 0x2;
-                            //Above cell
-                            if ((tmpy > 0) && (GameCell(tmpx, tmpy - 1).Path == ccell.Path))
-                                if ((GameCell(tmpx, tmpy - 1).ID == ccell.ID + 1) ||
-                                (GameCell(tmpx, tmpy - 1).ID + 1 == ccell.ID) ||
-                                ((GameCell(tmpx, tmpy -1).ID == ULONG_MAX) && (ccell.Joined)))
-                                    samepath |= 0x4;
-                            //Below cell
-                            if ((tmpy + 1 < Height) && (GameCell(tmpx, tmpy + 1).Path == ccell.Path))
-                                if ((GameCell(tmpx, tmpy + 1).ID == ccell.ID + 1) ||
-                                (GameCell(tmpx, tmpy + 1).ID + 1 == ccell.ID) ||
-                                ((GameCell(tmpx, tmpy +1).ID == ULONG_MAX) && (ccell.Joined)))
-                                    samepath |= 0x8;
-                            //Changes the text color
-                            TxColor(ccell.Path);
-                            //The cells arround the current that are in the same path are stored in samepath
-                            //There are 10 possibilities: only left (0x1), only right (0x2), only above (0x4), only below(0x8)
-                            //                            left and right (0x3), above and below (0xC), above and left (0x5), above and right (0x6)
-                            //                            below and left (0x9), below and right (0xA);
-                            switch(samepath){
-                                case 0x1:  // Left
-                                    printf(" + ");
-                                    break;
-                                case 0x2: // Right
-                                    printf(" + ");
-                                    break;
-                                case 0x3: // Left-Right
-                                    printf("---");
-                                    break;
-                                case 0x4: // Above
-                                    printf(" + ");
-                                    break;
-                                case 0x5: // Left - Above
-                                    printf("-' ");
-                                    break;
-                                case 0x6: // Right - Abobe
-                                    printf(" '-");
-                                    break;
-                                case 0x8: // Below
-                                    printf(" + ");
-                                    break;
-                                case 0x9: // Left - Below
-                                    printf("-. ");
-                                    break;
-                                case 0xA: // Right - Below
-                                    printf(" .-");
-                                    break;
-                                case 0xC: // Above - Below
-                                    printf(" | ");
-                                    break;
-                                default:
-                                    fprintf(stderr, "Error drawing the grid\n");
-                                    return;
-                            }
-                            Color_Reset;
-                        }
-                    } else { // Empty cell
-                        printf("   ");
+                } else if (IsEmpty(ccell)){
+                    out = PutText(out, "   ");
+                } else if (ccell.Endpoint){
+                    //The cell contains the start or the end of a path, it has at most one link: with a link on
+                    //the left or on the right it is drawn as a coloured block with the link on that side
+                    if (ccell.Links & (ccell.Links - 1)){
+                        fprintf(stderr, "Error drawing the grid\n");
+                        return 0;
+                    }
+                    if (ccell.Links == DIR_LEFT){
+                        out = PutColor(out, 0, ccell.Path);
+                        *out++ = '-';
+                        out = PutReset(out);
+                    } else
+                        *out++ = ' ';
+                    out = PutColor(out, 1, ccell.Path);
+                    *out++ = ' ';
+                    out = PutReset(out);
+                    if (ccell.Links == DIR_RIGHT){
+                        out = PutColor(out, 0, ccell.Path);
+                        *out++ = '-';
+                        out = PutReset(out);
+                    } else
+                        *out++ = ' ';
+                } else { //Cell is part of a path
+                    //The cells arround the current that are in the same path and linked to it are in Links
+                    out = PutColor(out, 0, ccell.Path);
+                    switch(ccell.Links){
+                        case DIR_LEFT:
+                        case DIR_RIGHT:
+                        case DIR_UP:
+                        case DIR_DOWN:
+                            out = PutText(out, " + ");
+                            break;
+                        case DIR_LEFT | DIR_RIGHT:
+                            out = PutText(out, "---");
+                            break;
+                        case DIR_LEFT | DIR_UP:
+                            out = PutText(out, "-' ");
+                            break;
+                        case DIR_RIGHT | DIR_UP:
+                            out = PutText(out, " '-");
+                            break;
+                        case DIR_LEFT | DIR_DOWN:
+                            out = PutText(out, "-. ");
+                            break;
+                        case DIR_RIGHT | DIR_DOWN:
+                            out = PutText(out, " .-");
+                            break;
+                        case DIR_UP | DIR_DOWN:
+                            out = PutText(out, " | ");
+                            break;
+                        default:
+                            fprintf(stderr, "Error drawing the grid\n");
+                            return 0;
                     }
+                    out = PutReset(out);
                 }
             }
-            printf("|\033[%d;%dH", print_y++, print_x);
+            *out++ = '|';
         }
+        out = PutCursor(out, print_y + y + 3, print_x + 1);
     }
-    for (x = 0; x < Width; x++){
-        printf("+---");
-    }
-    printf("+\033[%d;%dH", PrintPoint_y + y_end + 2, PrintPoint_x);
+    for (x = 0; x < Width; x++)
+        out = PutText(out, "+---");
+    *out++ = '+';
+    out = PutCursor(out, print_y + y_end + 2, print_x);
+    return out - FrameBuffer;
 }
 
-void ClearGrid(){
-    int x, y,  // x and y coordinate
-    x_end = Width,
-    y_end = Height*2 + 1,
-    print_x = PrintPoint_x+1, //x and y coordinates of the print point
-    print_y = PrintPoint_y+1;
-    printf("\033[%d;%dH", print_y++, print_x); //Move the cursor to 0; 0
-    for (y = 0; y < y_end; y++){
-        for (x = 0; x < x_end; x++)
-            printf("    "); //Print spaces instead of the grid
-        printf(" \033[%d;%dH", print_y++, print_x);
+int RenderBlank(int print_x, int print_y){ //Draws spaces where RenderGrid draws the grid, returns the length
+    int x, y;
+    char *out = FrameBuffer;
+    for (y = 0; y < Height*2 + 1; y++){
+        out = PutCursor(out, print_y + y + 1, print_x + 1);
+        for (x = 0; x < Width; x++)
+            out = PutText(out, "    ");
+        *out++ = ' ';
     }
+    out = PutCursor(out, print_y + y + 1, print_x + 1);
+    return out - FrameBuffer;
+}
+
+void WriteFrame(int len){ //Writes the frame out, the caller holds PrintLock
+    fwrite(FrameBuffer, 1, len, stdout);
+    fflush(stdout);
+}
+
+void PrintGrid(){ //Draws the grid of this thread at the print point
+    WriteFrame(RenderGrid(GameGrid, PrintPoint_x, PrintPoint_y));
+}
+
+void ClearGrid(){ //Clears the next place of the print point, where the animation draws
+    WriteFrame(RenderBlank(PrintPoint_x, PrintPoint_y));
     PrintPoint_x -= (Width * 4 + 5);
 }
-#undef PrintColor
-#undef Color_Reset
+
+__thread Cell *KeptSolutions = NULL; //If not NULL the grids of the first solutions found are copied here
+__thread int KeptSolutions_Len, KeptSolutions_Size;
+typedef void (*SolutionCallback)(const Cell *grid, void *data);
+__thread SolutionCallback OnSolution = NULL; //If not NULL it is called with each solution found
+__thread void *OnSolutionData;
 
 int CheckGame(){
-    int x, y;
-    for (y = 0; y < Height; y++)
-        for (x = 0; x < Width; x++)
-            if (IsEmpty(GameCell(x, y)))
-                return 0; //No solution was found
+    int c;
+    for (c = 0; c < Width*Height; c++)
+        if (IsEmpty(GameGrid[c]))
+            return 0; //No solution was found
     //if no Cell was empty
-    PrintGrid();
-    PrintPoint_x += Width * 4 + 5;
+    if ((KeptSolutions != NULL) && (KeptSolutions_Len < KeptSolutions_Size))
+        memcpy(&KeptSolutions[(KeptSolutions_Len++)*Width*Height], GameGrid, Width*Height*sizeof(Cell));
+    if (OnSolution != NULL)
+        OnSolution(GameGrid, OnSolutionData);
+    if (Draw){
+        pthread_mutex_lock(&PrintLock);
+        PrintGrid();
+        PrintPoint_x += Width * 4 + 5;
+        pthread_mutex_unlock(&PrintLock);
+    }
     return 1; //a solution found!
 }
 
-#ifdef ANIMATION
-void Wait(int millisecs){
-    int end = clock() + millisecs*CLOCKS_PER_SEC/1000;
-    while (clock() < end){}
+/*
+*  Statistics
+*  When STATISTICS is defined and the option -s is passed the search counts the nodes at each depth and for each path,
+*  the moves made from the nodes of each path (so its branching factor is known), the nodes cut off by each check, the
+*  flood fills of the reachability checks and the cells they visit, and the time spent in the reachability checks, in
+*  the dead end checks, in choosing the moves and in CheckGame. Each thread counts on its own and adds its counters to
+*  the totals when its search ends. Without STATISTICS the macros are empty, so the search doesn't pay for them.
+*/
+#define PRUNE_DEAD_END 0 //An empty cell can't be filled
+#define PRUNE_STRANDED 1 //A path can't be joined or a region can't be filled
+#define PRUNE_NO_MOVES 2 //The head of a path can't move
+#define PRUNE_SELF_TOUCH 3 //A move would put a path next to itself, counted for each move (see Self touch)
+#define PRUNE_CAUSES   4
+
+#define TIME_REACHABILITY 0 //RegionsFill, RegionsUndo and RegionsStranded
+#define TIME_DEAD_ENDS    1
+#define TIME_MOVES        2 //ForcedMove and SelectPath
+#define TIME_CHECK        3 //CheckGame
+#define TIMERS            4
+
+struct _Statistics {
+    unsigned long long Prunes[PRUNE_CAUSES], TableHits, RegionSplits, FloodFills, FloodCells, Time[TIMERS]; //Time in nanoseconds
+    int Depths, Paths; //Length of the arrays
+    unsigned long long *DepthNodes, *DepthCutOffs; //Nodes started and nodes cut off at each depth
+    unsigned long long *PathNodes, *PathForced, *PathMoves; //Branching and forced nodes of each path, moves made from the first ones
+};
+typedef struct _Statistics Statistics;
+
+#define STATS_TABLE 1
+#define STATS_JSON  2
+int StatsOutput = 0; //0 if the statistics are not kept, otherwise how they are printed
+
+#ifdef STATISTICS
+__thread Statistics Stat; //Counters of this thread
+Statistics Totals; //Counters of the threads whose search ended
+pthread_mutex_t StatsLock = PTHREAD_MUTEX_INITIALIZER;
+
+static inline unsigned long long StatNow(){
+    struct timespec t;
+    clock_gettime(CLOCK_MONOTONIC, &t);
+    return t.tv_sec*1000000000ULL + t.tv_nsec;
 }
-#endif
 
-int FloodFill(int px, int py, int endpx, int endpy){
-    if (GET_FLOOD_FILL_DATA(px, py)) //Cell must be void, otherwise the algorithm will be too long
-        return 0;
-    SET_FLOOD_FILL_DATA(px, py, (1));
-    //Above
-    if (px + 1 < Width){
-        if ((px+1 == endpx) && (py == endpy))
-            return 1;
-        if (IsEmpty(GameCell(px+1, py))){
-            if (FloodFill(px+1, py, endpx, endpy)) //when we know that one point can be reached from anoteher is unuseles going on the algoritm
-                return 1;
-        }
+#define StatCount(counter, n) do { if (StatsOutput) Stat.counter += (n); } while (0)
+#define StatStart(timer) unsigned long long timer = StatsOutput?(StatNow()):(0)
+#define StatStop(timer, which) do { if (StatsOutput) Stat.Time[which] += StatNow() - (timer); } while (0)
+
+void AllocStatistics(){ //The arrays of the counters of this thread, for games up to the size of the buffers
+    Stat.Depths = StackLen;
+    Stat.Paths = Points_Len;
+    if (((Stat.DepthNodes = calloc(Stat.Depths, sizeof(unsigned long long))) == NULL) ||
+    ((Stat.DepthCutOffs = calloc(Stat.Depths, sizeof(unsigned long long))) == NULL) ||
+    ((Stat.PathNodes = calloc(Stat.Paths + 1, sizeof(unsigned long long))) == NULL) ||
+    ((Stat.PathForced = calloc(Stat.Paths + 1, sizeof(unsigned long long))) == NULL) ||
+    ((Stat.PathMoves = calloc(Stat.Paths + 1, sizeof(unsigned long long))) == NULL)){
+        fprintf(stderr, "Error allocating memory\n");
+        abort();
     }
-    //Below
-    if (px > 0) {
-        if ((px-1 == endpx) && (py == endpy))
-            return 1;
-        if (IsEmpty(GameCell(px-1, py))){
-            if (FloodFill(px-1, py, endpx, endpy))
-                return 1;
-        }
+}
+
+void FreeStatistics(){
+    free(Stat.PathMoves);
+    free(Stat.PathForced);
+    free(Stat.PathNodes);
+    free(Stat.DepthCutOffs);
+    free(Stat.DepthNodes);
+}
+
+unsigned long long *GrowCounters(unsigned long long *counters, int len, int new_len){ //Adds counters set to 0
+    int i;
+    if ((counters = realloc(counters, (new_len + 1)*sizeof(unsigned long long))) == NULL){
+        fprintf(stderr, "Error allocating memory\n");
+        abort();
     }
-    //Right
-    if (py + 1 < Height) {
-        if ((px == endpx) && (py+1 == endpy))
-            return 1;
-        if (IsEmpty(GameCell(px, py+1))){
-            if (FloodFill(px, py+1, endpx, endpy))
-                return 1;
-        }
+    for (i = len; i <= new_len; i++)
+        counters[i] = 0;
+    return counters;
+}
+
+void AddStatistics(){ //Adds the counters of this thread to the totals and clears them
+    int i;
+    if (!StatsOutput)
+        return;
+    pthread_mutex_lock(&StatsLock);
+    if (Totals.Depths < Stat.Depths){
+        Totals.DepthNodes = GrowCounters(Totals.DepthNodes, Totals.Depths, Stat.Depths);
+        Totals.DepthCutOffs = GrowCounters(Totals.DepthCutOffs, Totals.Depths, Stat.Depths);
+        Totals.Depths = Stat.Depths;
     }
-    //Left
-    if (py > 0) {
-        if ((px == endpx) && (py-1 == endpy))
-            return 1;
-        if (IsEmpty(GameCell(px, py-1))){
-            if (FloodFill(px, py-1, endpx, endpy))
-                return 1;
-        }
+    if (Totals.Paths < Stat.Paths){
+        Totals.PathNodes = GrowCounters(Totals.PathNodes, Totals.Paths, Stat.Paths);
+        Totals.PathForced = GrowCounters(Totals.PathForced, Totals.Paths, Stat.Paths);
+        Totals.PathMoves = GrowCounters(Totals.PathMoves, Totals.Paths, Stat.Paths);
+        Totals.Paths = Stat.Paths;
     }
-    return 0;
+    for (i = 0; i < PRUNE_CAUSES; i++)
+        Totals.Prunes[i] += Stat.Prunes[i];
+    for (i = 0; i < TIMERS; i++)
+        Totals.Time[i] += Stat.Time[i];
+    Totals.TableHits += Stat.TableHits;
+    Totals.RegionSplits += Stat.RegionSplits;
+    Totals.FloodFills += Stat.FloodFills;
+    Totals.FloodCells += Stat.FloodCells;
+    for (i = 0; i < Stat.Depths; i++){
+        Totals.DepthNodes[i] += Stat.DepthNodes[i];
+        Totals.DepthCutOffs[i] += Stat.DepthCutOffs[i];
+        Stat.DepthNodes[i] = Stat.DepthCutOffs[i] = 0;
+    }
+    for (i = 0; i < Stat.Paths; i++){
+        Totals.PathNodes[i] += Stat.PathNodes[i];
+        Totals.PathForced[i] += Stat.PathForced[i];
+        Totals.PathMoves[i] += Stat.PathMoves[i];
+        Stat.PathNodes[i] = Stat.PathForced[i] = Stat.PathMoves[i] = 0;
+    }
+    memset(Stat.Prunes, 0, sizeof(Stat.Prunes));
+    memset(Stat.Time, 0, sizeof(Stat.Time));
+    Stat.TableHits = Stat.RegionSplits = Stat.FloodFills = Stat.FloodCells = 0;
+    pthread_mutex_unlock(&StatsLock);
 }
 
-int Next(int current_x, int current_y){ //this is the most important funcion in the game
-    int CurrentPathID = GameCell(current_x, current_y).Path;
-    int solution = 0, tmpsolution;
-#ifdef ANIMATION
-    static int counter = 0;
-#endif
-#ifdef OPTIMIZATION /*This optimizes the algorithm avoiding it continue to solve an unsolvable position
-    *The prupose of the game is to join dots with a line wich can't cross another line,
-    *so if we found there is no way to connect two points of the game the function ends and returns 0
-    *(no solution). to check if we are in this situation for each point we expand an area from the point
-    *unless this area touch an alrelady present line, so the area expands itself only on white cells
-    *like a flood fill. When it's impossible to expand this area we find if the second point is inside,
-    *if not there's no way to connect them.
-    */
-    int op_c, op_p; //Optimizatior counter, Optimizatior point
-    //Frist reset the buffer
-    for (op_p = CurrentPathID; op_p < Points_Len; op_p++){
-        for (op_c = 0; op_c < FloodFillData_Len; op_c++)
-            FloodFillData[op_c] = 0x00;
-        if(!FloodFill(Points[op_p].x_start, Points[op_p].y_start, Points[op_p].x_end, Points[op_p].y_end))
-            return 0;
+void PrintStatistics(FILE *F){ //Prints the totals as a table or as a JSON object
+    const char *prunes[PRUNE_CAUSES] = {"dead_end", "stranded", "no_moves", "self_touch"},
+    *timers[TIMERS] = {"reachability", "dead_ends", "moves", "check"};
+    int i, first;
+    if (StatsOutput == STATS_JSON){
+        fprintf(F, "{\"prunes\": {");
+        for (i = 0; i < PRUNE_CAUSES; i++)
+            fprintf(F, "%s\"%s\": %llu", i?(", "):(""), prunes[i], Totals.Prunes[i]);
+        fprintf(F, "}, \"table_hits\": %llu, \"region_splits\": %llu, \"flood_fills\": %llu, \"flood_cells\": %llu, \"seconds\": {",
+        Totals.TableHits, Totals.RegionSplits, Totals.FloodFills, Totals.FloodCells);
+        for (i = 0; i < TIMERS; i++)
+            fprintf(F, "%s\"%s\": %.6f", i?(", "):(""), timers[i], Totals.Time[i]/1e9);
+        fprintf(F, "},\n \"depths\": [");
+        for (first = 1, i = 0; i < Totals.Depths; i++){
+            if (Totals.DepthNodes[i] == 0)
+                continue;
+            fprintf(F, "%s\n  {\"depth\": %d, \"nodes\": %llu, \"cut_off\": %llu}", first?(""):(","), i,
+            Totals.DepthNodes[i], Totals.DepthCutOffs[i]);
+            first = 0;
+        }
+        fprintf(F, "],\n \"paths\": [");
+        for (i = 0; i < Totals.Paths; i++)
+            fprintf(F, "%s\n  {\"path\": %d, \"nodes\": %llu, \"forced\": %llu, \"moves\": %llu, \"branching\": %.4f}",
+            i?(","):(""), i + 1, Totals.PathNodes[i], Totals.PathForced[i], Totals.PathMoves[i],
+            Totals.PathNodes[i]?((double)Totals.PathMoves[i]/Totals.PathNodes[i]):(0));
+        fprintf(F, "]}\n");
+        return;
     }
+    fprintf(F, "Cut off:");
+    for (i = 0; i < PRUNE_CAUSES; i++)
+        fprintf(F, " %s %llu", prunes[i], Totals.Prunes[i]);
+    fprintf(F, "\nTable hits: %llu\nRegion splits: %llu\nFlood fills: %llu, cells visited %llu\nSeconds:", Totals.TableHits,
+    Totals.RegionSplits, Totals.FloodFills, Totals.FloodCells);
+    for (i = 0; i < TIMERS; i++)
+        fprintf(F, " %s %.6f", timers[i], Totals.Time[i]/1e9);
+    fprintf(F, "\n\nDepth\tNodes\tCut off\n");
+    for (i = 0; i < Totals.Depths; i++)
+        if (Totals.DepthNodes[i] > 0)
+            fprintf(F, "%d\t%llu\t%llu\n", i, Totals.DepthNodes[i], Totals.DepthCutOffs[i]);
+    fprintf(F, "\nPath\tNodes\tForced\tMoves\tBranching\n");
+    for (i = 0; i < Totals.Paths; i++)
+        fprintf(F, "%d\t%llu\t%llu\t%llu\t%.4f\n", i + 1, Totals.PathNodes[i], Totals.PathForced[i], Totals.PathMoves[i],
+        Totals.PathNodes[i]?((double)Totals.PathMoves[i]/Totals.PathNodes[i]):(0));
+}
+#else
+#define StatCount(counter, n) do {} while (0)
+#define StatStart(timer) do {} while (0)
+#define StatStop(timer, which) do {} while (0)
 #endif
-    if (CurrentPathID == 0){
-        //The start cell must not be empty
-        return -1; //Exit with error
+
+#ifdef OPTIMIZATION
+/*
+*  Regions of empty cells
+*  Every empty cell is labelled with the number of the region (the set of empty cells connected to it) it belongs to,
+*  non empty cells have the label 0. Two endpoints can be joined only if they are adjacent or if they touch the same region.
+*  The labels are not computed again at every move: when a piece of a path fills a cell its region is split only if
+*  the empty cells around it are not connected through the ring of the 8 cells around it, and only in this case the
+*  cells of the region are flood filled with new labels. Every label changed is written in a log, so when the piece
+*  is removed the labels are restored going back in the log.
+*  The number of cells of each label is kept too, so the regions left are always known.
+*/
+struct _RegionLogEntry {
+    int Cell; //Index of the cell, -1 if this entry stores the value of NextRegion
+    int Label; //Label of the cell before the change
+};
+typedef struct _RegionLogEntry RegionLogEntry;
+
+__thread int *Region; //Region of each cell
+__thread int NextRegion; //First label not used
+__thread int *RegionQueue; //Queues used by the flood fills, RegionsFill uses 4 of them
+__thread unsigned *RegionVisit; //Cells visited by RegionsFill, the search which visited it and the stamp of the call
+__thread unsigned RegionStamp;
+__thread RegionLogEntry *RegionLog;
+__thread int RegionLog_Len, RegionLog_Size;
+__thread int *RegionSize; //Number of cells of each label
+__thread int RegionsAlive; //Number of labels given to at least one cell
+__thread unsigned *RegionServed; //Regions which can be filled by a path, the stamp of the call of RegionsStranded
+__thread unsigned ServedStamp;
+
+#define MaxRegions (4*Width*Height + 1) //Each fill gives at most 3 new labels
+
+void AllocRegions(){
+    RegionLog_Size = Width*Height*4;
+    if (((Region = malloc((Width*Height + 1)*sizeof(int))) == NULL) || //With the Sentinel
+    ((RegionSize = malloc(MaxRegions*sizeof(int))) == NULL) ||
+    ((RegionServed = calloc(MaxRegions, sizeof(unsigned))) == NULL) ||
+    ((RegionQueue = malloc(4*Width*Height*sizeof(int))) == NULL) ||
+    ((RegionVisit = calloc(Width*Height, sizeof(unsigned))) == NULL) ||
+    ((RegionLog = malloc(RegionLog_Size*sizeof(RegionLogEntry))) == NULL)){
+        fprintf(stderr, "Error allocating memory\n");
+        abort();
     }
-#ifdef ANIMATION
-    if (counter == 1000){
-        PrintGrid();
-        Wait(50);
-        counter = 0;
+}
+
+void FreeRegions(){
+    free(RegionLog);
+    free(RegionVisit);
+    free(RegionQueue);
+    free(RegionServed);
+    free(RegionSize);
+    free(Region);
+}
+
+void LogRegion(int cell, int label){
+    if (RegionLog_Len == RegionLog_Size){
+        RegionLog_Size *= 2;
+        if ((RegionLog = realloc(RegionLog, RegionLog_Size*sizeof(RegionLogEntry))) == NULL){
+            fprintf(stderr, "Error allocating memory\n");
+            abort();
+        }
     }
-    counter++;
-#endif
-    TriedOutPaths++; //Increase the number of tried out path
-    //Try to put the next piece of the path in the cell above the current one
-    //Above cell
-    if (current_x + 1 < Width) { //first make sure there is at least one cell above
-        if (IsEmpty(GameCell(current_x + 1, current_y)) ){ //Chek if the cell is free
-            //if it is we start filling it with the next piece of the path
-            GameCell(current_x + 1, current_y).Path = CurrentPathID;
-            GameCell(current_x + 1, current_y).ID = GameCell(current_x, current_y).ID+1;
-            tmpsolution = Next(current_x + 1, current_y); //Recursive function
-            if (solution < 0 || tmpsolution < 0) //if solutions contains already an error or if an error occurred in the before call to 'Next'
-                solution = tmpsolution; //reset the number of solution and store the error number
-            else
-                solution+=tmpsolution; //Add the solutions found
-            GameCell(current_x + 1, current_y).Path = 0;
-            GameCell(current_x + 1, current_y).ID = 0;
-        } else if ((GameCell(current_x + 1, current_y).Path == CurrentPathID) && (GameCell(current_x + 1, current_y).ID == ULONG_MAX)){
-            //If it is not free, but contains the end endpoint of the path
-            if (CurrentPathID < Points_Len){ //Try to go to the next path, if there are no more path the points are joined
-                //another path was found
-                int X_end = Points[CurrentPathID].x_end, //et some variables
-                Y_end = Points[CurrentPathID].y_end;
-                GameCell(current_x, current_y).Joined = 1; //The cell was joined to the endpoint
-                tmpsolution = Next(Points[CurrentPathID].x_start, Points[CurrentPathID].y_start); //Recursive function
-                if (solution < 0 || tmpsolution < 0)
-                    solution = tmpsolution;
-                else
-                    solution+=tmpsolution;
-                GameCell(current_x, current_y).Joined = 0;
-            } else {
-                //Every point was joined, check the solution (there must not be any empty cells), and then print it
-                GameCell(current_x, current_y).Joined = 1;
-                solution = CheckGame();
-                GameCell(current_x, current_y).Joined = 0;
-                return solution;
+    RegionLog[RegionLog_Len].Cell = cell;
+    RegionLog[RegionLog_Len].Label = label;
+    RegionLog_Len++;
+}
+
+static inline void SetRegion(int cell, int label){ //Changes the label of the cell keeping the sizes up to date
+    if (Region[cell] && (--RegionSize[Region[cell]] == 0))
+        RegionsAlive--;
+    if (label && (RegionSize[label]++ == 0))
+        RegionsAlive++;
+    Region[cell] = label;
+}
+
+void FloodFillRegion(int cell, int label, int log){ //Gives the label to every empty cell connected to cell
+    int head = 0, tail = 0, i, n;
+    if (log)
+        LogRegion(cell, Region[cell]);
+    SetRegion(cell, label);
+    RegionQueue[tail++] = cell;
+    while (head < tail){
+        cell = RegionQueue[head++];
+        //The neighbours are added to the queue and labelled at once, so each cell enters the queue only once
+        for (i = 0; i < 4; i++){
+            n = Neighbour(cell, i);
+            if (IsEmpty(GameGrid[n]) && (Region[n] != label)){
+                if (log)
+                    LogRegion(n, Region[n]);
+                SetRegion(n, label);
+                RegionQueue[tail++] = n;
             }
         }
     }
-    //Below cell
-    if (current_x > 0) {
-        if (IsEmpty(GameCell(current_x - 1, current_y)) ){
-            GameCell(current_x - 1, current_y).Path = CurrentPathID;
-            GameCell(current_x - 1, current_y).ID = GameCell(current_x, current_y).ID+1;
-            tmpsolution = Next(current_x-1, current_y); //Recursive function
-            if (solution < 0 || tmpsolution < 0)
-                solution = tmpsolution;
-            else
-                solution+=tmpsolution;
-            GameCell(current_x - 1, current_y).Path = 0;
-            GameCell(current_x - 1, current_y).ID = 0;
-        } else if ((GameCell(current_x - 1, current_y).Path == CurrentPathID) && (GameCell(current_x - 1, current_y).ID == ULONG_MAX)){
-            if (CurrentPathID < Points_Len){
-                int X_end = Points[CurrentPathID].x_end,
-                Y_end = Points[CurrentPathID].y_end;
-                GameCell(current_x, current_y).Joined = 1; //The cell was joined to the endpoint
-                tmpsolution = Next(Points[CurrentPathID].x_start, Points[CurrentPathID].y_start); //Recursive function
-                if (solution < 0 || tmpsolution < 0)
-                    solution = tmpsolution;
-                else
-                    solution+=tmpsolution;
-                GameCell(current_x, current_y).Joined = 0;
-            } else {
-                //Every point was joined, check the solution (there must not be any empty cells), and then print it
-                GameCell(current_x, current_y).Joined = 1;
-                solution = CheckGame();
-                GameCell(current_x, current_y).Joined = 0;
-                return solution;
-            }
+    StatCount(FloodFills, 1);
+    StatCount(FloodCells, tail);
+}
+
+void InitRegions(){ //Computes the labels from scratch
+    int c;
+    RegionLog_Len = 0;
+    RegionStamp = 0;
+    NextRegion = 1;
+    RegionsAlive = 0;
+    ServedStamp = 0;
+    for (c = 0; c < Width*Height; c++)
+        Region[c] = RegionVisit[c] = 0;
+    Region[Sentinel] = 0;
+    for (c = 0; c < MaxRegions; c++)
+        RegionSize[c] = RegionServed[c] = 0;
+    for (c = 0; c < Width*Height; c++)
+        if (IsEmpty(GameGrid[c]) && (Region[c] == 0))
+            FloodFillRegion(c, NextRegion++, 0);
+}
+
+int RegionGroup(int *parent, int g){ //Finds the group g was merged in
+    while (parent[g] != g)
+        g = parent[g];
+    return g;
+}
+
+const int RingMoves[4] = {0, 2, 1, 3}; //Moves to the adjacent cells going clockwise from the right one (see MoveX)
+
+int RegionsFill(int cell){ //Updates the labels after the cell was filled, returns the mark to undo the changes
+    int mark = RegionLog_Len,
+    side[4], //The adjacent cells, in the order of RingMoves
+    ring[8], //The 8 cells around, starting from the right one and going clockwise, the even ones are the adjacent cells
+    group[8], //Group of each adjacent cell
+    parent[4], head[4], tail[4], done[4], //Groups of the search, each one has its queue
+    i, g, h, c, n, adjacent = 0, links = 0, groups = 0, alive, exhausted;
+    LogRegion(-1, NextRegion);
+    LogRegion(cell, Region[cell]);
+    SetRegion(cell, 0);
+    for (i = 0; i < 4; i++){ //The corner after each adjacent cell is the next move from it, the Sentinel has no region
+        side[i] = Neighbour(cell, RingMoves[i]);
+        ring[2*i] = (Region[side[i]] != 0);
+        ring[2*i + 1] = (Region[Neighbour(side[i], RingMoves[(i + 1) & 0x3])] != 0);
+    }
+    for (i = 0; i < 8; i += 2){
+        adjacent += ring[i];
+        links += ring[i] && ring[i + 1] && ring[(i + 2) & 0x7];
+    }
+    //If the empty adjacent cells are still joined through the ring the region can't be split
+    if ((adjacent < 2) || (adjacent - links <= 1))
+        return mark;
+    /*
+    *Otherwise the parts starting from the adjacent cells are searched at the same time, one cell each in turn.
+    *When two searches meet their parts are the same, when one ends before meeting the others its part was split
+    *from the region and it takes a new label. When only one search is left its part keeps the old label.
+    *So only the smallest parts are visited.
+    */
+    if (++RegionStamp == 0x40000000){ //Stamps are over, start again
+        for (c = 0; c < Width*Height; c++)
+            RegionVisit[c] = 0;
+        RegionStamp = 1;
+    }
+    for (i = 0; i < 8; i += 2){
+        if (!ring[i])
+            continue;
+        g = group[i] = groups++;
+        parent[g] = g;
+        done[g] = 0;
+        head[g] = 0;
+        tail[g] = 1;
+        n = side[i/2];
+        RegionQueue[g*Width*Height] = n;
+        RegionVisit[n] = (RegionStamp << 2) | g;
+    }
+    alive = groups;
+    for (i = 0; i < 8; i += 2){ //The cells joined through the ring are in the same part
+        if (ring[i] && ring[i + 1] && ring[(i + 2) & 0x7] &&
+        ((g = RegionGroup(parent, group[i])) != (h = RegionGroup(parent, group[(i + 2) & 0x7])))){
+            parent[h] = g;
+            alive--;
         }
     }
-    //Right cell
-    if (current_y + 1 < Height) {
-        if (IsEmpty(GameCell(current_x, current_y + 1)) ){
-            GameCell(current_x, current_y + 1).Path = CurrentPathID;
-            GameCell(current_x, current_y + 1).ID = GameCell(current_x, current_y).ID+1;
-            tmpsolution = Next(current_x, current_y + 1); //Recursive function
-            if (solution < 0 || tmpsolution < 0)
-                solution = tmpsolution;
-            else
-                solution+=tmpsolution;
-            GameCell(current_x, current_y + 1).Path = 0;
-            GameCell(current_x, current_y + 1).ID = 0;
-        } else if ((GameCell(current_x, current_y + 1).Path == CurrentPathID) && (GameCell(current_x, current_y + 1).ID == ULONG_MAX)){
-            if (CurrentPathID < Points_Len){
-                int X_end = Points[CurrentPathID].x_end,
-                Y_end = Points[CurrentPathID].y_end;
-                GameCell(current_x, current_y).Joined = 1; //The cell was joined to the endpoint
-                tmpsolution = Next(Points[CurrentPathID].x_start, Points[CurrentPathID].y_start); //Recursive function
-                if (solution < 0 || tmpsolution < 0)
-                    solution = tmpsolution;
-                else
-                    solution+=tmpsolution;
-                GameCell(current_x, current_y).Joined = 0;
-            } else {
-                //Every point was joined, check the solution (there must not be any empty cells), and then print it
-                GameCell(current_x, current_y).Joined = 1;
-                solution = CheckGame();
-                GameCell(current_x, current_y).Joined = 0;
-                return solution;
+    while (alive > 1){
+        for (g = 0; g < groups; g++){
+            if (head[g] == tail[g])
+                continue;
+            c = RegionQueue[g*Width*Height + head[g]++];
+            for (i = 0; i < 4; i++){
+                if (Region[n = Neighbour(c, i)] == 0)
+                    continue;
+                if ((RegionVisit[n] >> 2) == RegionStamp){
+                    if ((h = RegionGroup(parent, RegionVisit[n] & 0x3)) != RegionGroup(parent, g)){
+                        parent[h] = RegionGroup(parent, g); //The two searches met
+                        alive--;
+                    }
+                } else {
+                    RegionVisit[n] = (RegionStamp << 2) | g;
+                    RegionQueue[g*Width*Height + tail[g]++] = n;
+                }
             }
         }
-    }
-    //left cell
-    if (current_y > 0) {
-        if (IsEmpty(GameCell(current_x, current_y - 1)) ){
-            GameCell(current_x, current_y - 1).Path = CurrentPathID;
-            GameCell(current_x, current_y - 1).ID = GameCell(current_x, current_y).ID+1;
-            tmpsolution = Next(current_x, current_y - 1); //Recursive function
-            if (solution < 0 || tmpsolution < 0)
-                solution = tmpsolution;
-            else
-                solution+=tmpsolution;
-            GameCell(current_x, current_y - 1).Path = 0;
-            GameCell(current_x, current_y - 1).ID = 0;
-        } else if ((GameCell(current_x, current_y - 1).Path == CurrentPathID) && (GameCell(current_x, current_y - 1).ID == ULONG_MAX)){
-            if (CurrentPathID < Points_Len){
-                int X_end = Points[CurrentPathID].x_end,
-                Y_end = Points[CurrentPathID].y_end;
-                GameCell(current_x, current_y).Joined = 1; //The cell was joined to the endpoint
-                tmpsolution = Next(Points[CurrentPathID].x_start, Points[CurrentPathID].y_start); //Recursive function
-                if (solution < 0 || tmpsolution < 0)
-                    solution = tmpsolution;
-                else
-                    solution+=tmpsolution;
-                GameCell(current_x, current_y).Joined = 0;
-            } else {
-                //Every point was joined, check the solution (there must not be any empty cells), and then print it
-                GameCell(current_x, current_y).Joined = 1;
-                solution = CheckGame();
-                GameCell(current_x, current_y).Joined = 0;
-                return solution;
+        for (g = 0; (g < groups) && (alive > 1); g++){
+            if ((parent[g] != g) || done[g])
+                continue;
+            for (exhausted = 1, h = 0; h < groups; h++)
+                if ((RegionGroup(parent, h) == g) && (head[h] < tail[h]))
+                    exhausted = 0;
+            if (!exhausted)
+                continue;
+            //This part is closed, so it's a new region
+            for (h = 0; h < groups; h++){
+                if (RegionGroup(parent, h) != g)
+                    continue;
+                for (i = 0; i < tail[h]; i++){
+                    n = RegionQueue[h*Width*Height + i];
+                    LogRegion(n, Region[n]);
+                    SetRegion(n, NextRegion);
+                }
             }
+            NextRegion++;
+            done[g] = 1;
+            alive--;
         }
     }
-    return solution; //it returns the number of solution or the error number
+    StatCount(FloodFills, 1);
+    for (g = 0; g < groups; g++)
+        StatCount(FloodCells, tail[g]);
+    return mark;
 }
 
-int Solve(){
-    if (Points_Len)
-        return Next(Points[0].x_start, Points[0].y_start);
-    else
-        return 0; //Could not solve
+void RegionsUndo(int mark){ //Restores the labels as they were when the mark was taken
+    while (RegionLog_Len > mark){
+        RegionLog_Len--;
+        if (RegionLog[RegionLog_Len].Cell < 0)
+            NextRegion = RegionLog[RegionLog_Len].Label;
+        else
+            SetRegion(RegionLog[RegionLog_Len].Cell, RegionLog[RegionLog_Len].Label);
+    }
 }
 
-int main(int argc, char * argv[]){
-    unsigned x, y;
-    int solutionsfound;
-    FILE * F;
-    struct timeval start, end;
-    gettimeofday(&start, NULL);
-    //chek that the user passed at least one argument
-    if (argc < 2){
-        fprintf(stderr, "Error, insufficient args\nYou have to pass at least the game data file\n");
-        abort();
-    }
-    //Open the file
-    if ((F = fopen(argv[1], "r")) == NULL){ //the first argument should be the file containing the game data
-        fprintf(stderr, "Error opening file\nMaybe the file does not exist\n");
-        abort();
-    }
-    //Start reading the file
-    //The first two numbers are the width and the heigt of the game grid
-    if (fscanf(F, "%d %d", &Width, &Height) != 2){ //if fscanf reads less than 2 numbers there is an error in the file
-        fprintf(stderr, "Error reading file, data corrupted\nI wasn't able to read the size of the game\n");
-        abort();
+int RegionsStranded(){ //Checks if a path or a region was cut off
+    /*
+    *The rest of a path goes through the empty cells of a single region, which must touch both its head and its
+    *tail. Every region will be filled, so it must be touched by both the ends of a path, and each path can fill
+    *only one region.
+    */
+    const int *start, *end;
+    int i, j, p, label, reachable, served = 0;
+    if (RegionsAlive > Unfinished)
+        return 1; //More regions than paths
+    if (++ServedStamp == 0){ //Stamps are over, start again
+        for (i = 0; i < MaxRegions; i++)
+            RegionServed[i] = 0;
+        ServedStamp = 1;
     }
-    //the third number written in the file is the number of lines
-    if (fscanf(F, "%d", &Points_Len) != 1){
-        fprintf(stderr, "Error reading file, data corrupted\nI wasn't able to read the number of paths\n");
-        abort();
+    for (p = 0; p < Points_Len; p++){
+        if (Heads[p] < 0)
+            continue; //Already joined
+        start = &Neighbour(Heads[p], 0);
+        end = &Neighbour(Tails[p], 0);
+        reachable = (start[0] == Tails[p]) || (start[1] == Tails[p]) || (start[2] == Tails[p]) ||
+        (start[3] == Tails[p]); //Adjacent
+        for (i = 0; i < 4; i++){
+            if ((label = Region[start[i]]) == 0)
+                continue; //Outside the grid or not empty
+            for (j = 0; j < 4; j++){
+                if (Region[end[j]] == label){
+                    reachable = 1;
+                    if (RegionServed[label] != ServedStamp){
+                        RegionServed[label] = ServedStamp;
+                        served++;
+                    }
+                    break;
+                }
+            }
+        }
+        if (!reachable)
+            return 1; //The ends of the path can't be joined any more
     }
-    //Allocating memory for points
-    if ((Points = malloc(Points_Len * sizeof(PathPoint))) == NULL){
+    return served < RegionsAlive; //A region can't be filled
+}
+#endif
+
+/*
+*  Transposition table
+*  Different orders of the moves can lead to the same position, the same cells filled and the same heads and tails of
+*  the paths, and then the same subtree would be searched again. When the table is enabled the number of solutions of
+*  each subtree is stored with a Zobrist hash of its position (a random key for each filled cell and one for each head
+*  or tail of each path on each cell, xored together), so when the position is found again the solutions are taken
+*  from it. The head and the tail of a path have the same keys, so the hash doesn't change when they are swapped.
+*  The table is shared by the threads without locks: each entry stores its key xored with its data, so an entry
+*  written by two threads at the same time doesn't match any position. The entries are in buckets of 4: a new one
+*  takes the place of the entry with the smallest subtree, or with the "always" policy the same place of the bucket
+*  every time, so the last position stored wins.
+*/
+struct _TableEntry {
+    unsigned long long Check; //Key of the position xored with Data
+    unsigned long long Data; //Solutions in the high 32 bits, nodes of the subtree in the low 32 bits
+};
+typedef struct _TableEntry TableEntry;
+
+#define BUCKET_LEN 4 //Entries in each bucket, a bucket fills a cache line
+
+__thread int TableMB = 0; //Memory used by the table in MB, 0 disables it
+__thread int ReplaceAlways = 0; //Replacement policy, 1 always overwrites, 0 keeps the biggest subtrees
+__thread TableEntry *Table = NULL;
+__thread unsigned long long TableMask; //Number of buckets - 1
+__thread unsigned long long *CellKeys, *HeadKeys; //Keys of the filled cells, and of the head or tail of each path on each cell
+__thread unsigned long long *PathKeys; //Key of each path, for the searches of the regions (see Independent regions)
+__thread unsigned long long Hash; //Hash of the current position
+__thread int NoSelfTouch = 0; //1 if a path can't be next to itself (see Self touch)
+//Without self touches the solutions of a position depend on the path of each cell too, so each path has its own keys
+#define CellKey(path, cell) CellKeys[(NoSelfTouch)?(((path) - 1)*Width*Height + (cell)):(cell)]
+
+unsigned long long RandomKey(unsigned long long *state){ //xorshift64*, the keys are the same at every run
+    *state ^= *state >> 12;
+    *state ^= *state << 25;
+    *state ^= *state >> 27;
+    return *state * 0x2545F4914F6CDD1DULL;
+}
+
+void AllocTable(){
+    unsigned long long buckets = 1, state = 0x9E3779B97F4A7C15ULL;
+    int i;
+    while (buckets*2*BUCKET_LEN*sizeof(TableEntry) <= (unsigned long long)TableMB << 20)
+        buckets *= 2;
+    TableMask = buckets - 1;
+    if (((Table = calloc(buckets*BUCKET_LEN, sizeof(TableEntry))) == NULL) ||
+    ((CellKeys = malloc((NoSelfTouch?(Points_Len):(1))*Width*Height*sizeof(unsigned long long))) == NULL) ||
+    ((HeadKeys = malloc(Points_Len*Width*Height*sizeof(unsigned long long))) == NULL) ||
+    ((PathKeys = malloc(Points_Len*sizeof(unsigned long long))) == NULL)){
         fprintf(stderr, "Error allocating memory\n");
         abort();
     }
-    for (x = 0; x < Points_Len; x++){
-        //reading the coordinates of the endpoints of the paths
-        if (fscanf(F, "%d\t%d\t%d\t%d", &(Points[x].x_start), &(Points[x].y_start), &(Points[x].x_end), &(Points[x].y_end)) != 4) {
-            fprintf(stderr, "Error reading file, data corrupted\nI wasn't able to read one or more of the coordinates of the endpoints of the path %d\n", x+1);
-            free(Points);
-            abort();
-        }
-        //Checking thath the endpoins are inside the grid size
-        if ((Points[x].x_start >= Width) || (Points[x].x_end >= Width) || (Points[x].y_start >= Height) || (Points[x].x_end >= Height)){
-            fprintf(stderr, "Error: data conflict\nThe endpoints of the path %d must be inside the game grid, check th grid's size\n", x+1);
-            free(Points);
-            abort();
-        }
-        //Cheking that the endpoints of the pats are differents
-        if ((Points[x].x_start == Points[x].x_end) && (Points[x].y_start == Points[x].y_end)){
-            fprintf(stderr, "Error: data conflict\nThe two endpoints of the path %d must be differents\n", x+1);
-            free(Points);
-            abort();
+    for (i = 0; i < (NoSelfTouch?(Points_Len):(1))*Width*Height; i++)
+        CellKeys[i] = RandomKey(&state);
+    for (i = 0; i < Points_Len*Width*Height; i++)
+        HeadKeys[i] = RandomKey(&state);
+    for (i = 0; i < Points_Len; i++)
+        PathKeys[i] = RandomKey(&state);
+}
+
+void FreeTable(){
+    free(PathKeys);
+    free(HeadKeys);
+    free(CellKeys);
+    free(Table);
+}
+
+void InitHash(){ //Computes the hash of the position from scratch
+    int c, p;
+    Hash = 0;
+    for (c = 0; c < Width*Height; c++)
+        if (IsNotEmpty(GameGrid[c]))
+            Hash ^= CellKey(GameGrid[c].Path, c);
+    for (p = 0; p < Points_Len; p++)
+        if (Heads[p] >= 0)
+            Hash ^= HeadKeys[p*Width*Height + Heads[p]] ^ HeadKeys[p*Width*Height + Tails[p]];
+}
+
+int TableLookup(long long *solutions){ //Looks for the current position, returns 1 and its solutions if it is found
+    TableEntry *bucket = &Table[(Hash & TableMask)*BUCKET_LEN];
+    unsigned long long data;
+    int i;
+    for (i = 0; i < BUCKET_LEN; i++){
+        data = bucket[i].Data;
+        if ((bucket[i].Check ^ data) == Hash){
+            *solutions = data >> 32;
+            return 1;
         }
-        //Checking that no endpoints are in the same cell
-        for (y = 0; y < x; y++){
-            if (((Points[x].x_start == Points[y].x_start) && (Points[x].y_start == Points[y].y_start)) ||
-            ((Points[x].x_end == Points[y].x_end)     && (Points[x].y_end == Points[y].y_end))	  ||
-            ((Points[x].x_end == Points[y].x_start)   && (Points[x].y_end == Points[y].y_start))   ||
-            ((Points[x].x_start == Points[y].x_end)   && (Points[x].y_start == Points[y].y_end)) ) {
-                fprintf(stderr, "Error: data conflict\nThe endpoints of the path %d must be different from the path %d's one\n", x+1, y+1);
-                free(Points);
-                abort();
+    }
+    return 0;
+}
+
+void TableStore(long long solutions, unsigned long long nodes){ //Stores the solutions of the subtree of the current position
+    TableEntry *bucket = &Table[(Hash & TableMask)*BUCKET_LEN];
+    unsigned long long data = ((unsigned long long)solutions << 32) | ((nodes > 0xFFFFFFFF)?(0xFFFFFFFF):(nodes));
+    int i, victim = (Hash >> 62) & (BUCKET_LEN - 1);
+    if ((solutions < 0) || (solutions > 0xFFFFFFFF))
+        return; //An error, or too many to fit in the entry: the subtree will be searched again
+    if (!ReplaceAlways){
+        for (i = 0; i < BUCKET_LEN; i++){
+            if ((bucket[i].Check ^ bucket[i].Data) == Hash){
+                victim = i; //Already stored by another thread
+                break;
             }
+            if ((bucket[i].Data & 0xFFFFFFFF) < (bucket[victim].Data & 0xFFFFFFFF))
+                victim = i;
         }
     }
-    //Finish reading the file!
+    bucket[victim].Data = data;
+    bucket[victim].Check = Hash ^ data;
+}
 
-    //Initialiting matrix
-    GameGrid = malloc(Width*Height*sizeof(Cell));
-    //Cause of there can be different size game it's better to use a multidimensional array,
-    //but the code to manage a multidimensional dynamic array is to long and difficoult, so the easiest
-    //way to do so is using a monodimensional dynamic array
+/*
+*  Game data
+*  The workers of a parallel search run in their own threads, so they copy from the thread which started them the
+*  description of the game and the data computed from it, which are shared and never changed during the search.
+*/
+struct _GameData {
+    PathPoint *Points;
+    int Width, Height, Points_Len;
+    int *Neighbours;
+    struct _Symmetry *Symmetries;
+    int Symmetries_Len, SymmetryRoots[MAX_SYMMETRIES], SymmetryDepth;
+    TableEntry *Table;
+    unsigned long long TableMask, *CellKeys, *HeadKeys, *PathKeys;
+};
+typedef struct _GameData GameData;
 
-    FloodFillData_Len = ceil(Width*Height/8.0);
-    FloodFillData = malloc(FloodFillData_Len);
+void SaveGameData(GameData *d){
+    d->Points = Points;
+    d->Width = Width;
+    d->Height = Height;
+    d->Points_Len = Points_Len;
+    d->Neighbours = Neighbours;
+    d->Symmetries = Symmetries;
+    d->Symmetries_Len = Symmetries_Len;
+    memcpy(d->SymmetryRoots, SymmetryRoots, sizeof(SymmetryRoots));
+    d->SymmetryDepth = SymmetryDepth;
+    d->Table = Table;
+    d->TableMask = TableMask;
+    d->CellKeys = CellKeys;
+    d->HeadKeys = HeadKeys;
+    d->PathKeys = PathKeys;
+}
 
-    //Reset the GameGrid Array
-    //The GameGrid Array is mono-dimensional, but it is used as a multidimensional array
-    //The reset of the whole array it is faster with a single cycle instead of two nested cycles
-    for (x = 0; x < Width*Height; x++){
-        GameGrid[x].Path = GameGrid[x].Joined = GameGrid[x].ID = 0;
+void LoadGameData(GameData *d){
+    Points = d->Points;
+    Width = d->Width;
+    Height = d->Height;
+    Points_Len = d->Points_Len;
+    Neighbours = d->Neighbours;
+    Symmetries = d->Symmetries;
+    Symmetries_Len = d->Symmetries_Len;
+    memcpy(SymmetryRoots, d->SymmetryRoots, sizeof(SymmetryRoots));
+    SymmetryDepth = d->SymmetryDepth;
+    Table = d->Table;
+    TableMask = d->TableMask;
+    CellKeys = d->CellKeys;
+    HeadKeys = d->HeadKeys;
+    PathKeys = d->PathKeys;
+}
+
+#ifdef ANIMATION
+/*
+*  Animation
+*  The search is drawn by its own thread, so the search never waits for the terminal: at each frame the animation
+*  thread asks for a snapshot of the grid, the first search thread that enters a node copies its grid if nobody else
+*  is copying it (it never waits for the lock), and at the next frame the animation thread draws the last snapshot
+*  taken where the next solution will be drawn.
+*/
+#define ANIMATION_FPS 20
+
+Cell *Snapshot; //Copy of the grid of a search thread
+int SnapshotWanted = 0, SnapshotTaken = 0; //The first is read by the search without the lock
+pthread_mutex_t SnapshotLock = PTHREAD_MUTEX_INITIALIZER;
+pthread_t AnimationThread;
+int AnimationRunning = 0;
+GameData AnimationData; //The game drawn
+
+static inline void OfferSnapshot(){ //Called by the search at each node, copies the grid if the animation wants it
+    if (__atomic_load_n(&SnapshotWanted, __ATOMIC_RELAXED) && !pthread_mutex_trylock(&SnapshotLock)){
+        memcpy(Snapshot, GameGrid, Width*Height*sizeof(Cell));
+        __atomic_store_n(&SnapshotWanted, 0, __ATOMIC_RELAXED);
+        SnapshotTaken = 1;
+        pthread_mutex_unlock(&SnapshotLock);
     }
-    //For a description of the format of the grid's cell go where I defined the struct _Cell
-    for (x = 0; x < Points_Len; x++){
-        GameCell(Points[x].x_start, Points[x].y_start).Path = (x+1);
-        GameCell(Points[x].x_start, Points[x].y_start).ID   = 0;
-        GameCell(Points[x].x_end  , Points[x].y_end  ).Path = (x+1);
-        GameCell(Points[x].x_end  , Points[x].y_end  ).ID   = ULONG_MAX;
+}
+
+void *AnimationMain(void *arg){
+    struct timespec period = {0, 1000000000L/ANIMATION_FPS};
+    Cell *frame;
+    int taken;
+    LoadGameData(&AnimationData);
+    AllocFrame();
+    if ((frame = malloc(Width*Height*sizeof(Cell))) == NULL){
+        fprintf(stderr, "Error allocating memory\n");
+        abort();
     }
-#ifdef RANDOM_COLOR
-    srand(time(NULL));  //Starts the random generator
-    Randq = rand();
-    Randm = rand();
-#endif
-    PrintPoint_x = 1;
-    PrintPoint_y = 1; //Prints the upper left corner of the grid in the point (1; 1)
-    printf("\033[2J"); //Clear the screen
-    solutionsfound = Solve(); //Solves the game
-    ClearGrid();
-    if (solutionsfound < 0) {
-        fprintf(stderr, "Error solving the game\n");
-        free(GameGrid);
-        free(Points);
-        exit(-1);
-    } else {
-        gettimeofday(&end, NULL);
-        printf("\n\n.----------.\n| Success! |   Time taken: %.6f seconds\n'----------'   Tried out %llu paths\n", ((end.tv_sec + (double)end.tv_usec/1e6) - (start.tv_sec + (double)start.tv_usec/1e6)), TriedOutPaths);
-        if (solutionsfound == 0)
-            printf("Were found no solutions :(\n");
-        else if (solutionsfound == 1)
-            printf("Were found only one solution :)\n");
-        else
-            printf("Were found %d solutions :)\n", solutionsfound);
+    while (__atomic_load_n(&AnimationRunning, __ATOMIC_RELAXED)){
+        nanosleep(&period, NULL);
+        pthread_mutex_lock(&SnapshotLock);
+        if ((taken = SnapshotTaken))
+            memcpy(frame, Snapshot, Width*Height*sizeof(Cell));
+        SnapshotTaken = 0;
+        __atomic_store_n(&SnapshotWanted, 1, __ATOMIC_RELAXED);
+        pthread_mutex_unlock(&SnapshotLock);
+        if (!taken)
+            continue;
+        pthread_mutex_lock(&PrintLock);
+        WriteFrame(RenderGrid(frame, PrintPoint_x, PrintPoint_y));
+        pthread_mutex_unlock(&PrintLock);
     }
-    free(FloodFillData);
-    free(GameGrid);
-    free(Points);
-    return 0;
+    free(frame);
+    FreeFrame();
+    return NULL;
 }
+
+void StartAnimation(){
+    if ((Snapshot = malloc(Width*Height*sizeof(Cell))) == NULL){
+        fprintf(stderr, "Error allocating memory\n");
+        abort();
+    }
+    SaveGameData(&AnimationData);
+    SnapshotWanted = SnapshotTaken = 0;
+    AnimationRunning = 1;
+    if (pthread_create(&AnimationThread, NULL, AnimationMain, NULL)){
+        fprintf(stderr, "Error creating the threads\n");
+        abort();
+    }
+}
+
+void StopAnimation(){
+    __atomic_store_n(&AnimationRunning, 0, __ATOMIC_RELAXED);
+    pthread_join(AnimationThread, NULL);
+    SnapshotWanted = 0;
+    free(Snapshot);
+}
+#endif
+
+/*
+*  Solution limit
+*  When only the first solutions are needed (is there one? is it the only one?) the search stops as soon as it has
+*  found SolutionLimit of them, counting the solutions taken from the table too. The counter is shared by the workers
+*  of a parallel search, so when one of them reaches the limit every worker stops. The result tells if the game has
+*  no solutions, only one, more than one, or at least one when the search was stopped at the first solution, and it
+*  is the exit code of the program when a limit is set.
+*/
+struct _Limit {
+    long long Found; //Solutions found so far
+    volatile int Stopped; //1 when the limit was reached
+};
+typedef struct _Limit Limit;
+
+#define RESULT_UNIQUE   0
+#define RESULT_NONE     1
+#define RESULT_MULTIPLE 2
+#define RESULT_SOME     3 //At least one, the search was stopped at the first one
+#define RESULT_ERROR    4
+
+#define SOLUTIONS_OVERFLOW -2 //Error number of a search whose solutions don't fit in a long long
+
+const char *ResultNames[5] = {"unique", "none", "multiple", "some", "error"};
+__thread int SolutionLimit = 0; //The search stops after this number of solutions, 0 if it finds all of them
+__thread Limit *SearchLimit; //Counter of the current search
+
+static inline void FoundSolutions(long long solutions){ //Counts the solutions found, and stops the search at the limit
+    if (SolutionLimit && (solutions > 0) && (__sync_add_and_fetch(&(SearchLimit->Found), solutions) >= SolutionLimit))
+        SearchLimit->Stopped = 1;
+}
+
+int Result(long long solutions){ //What the number of solutions returned by Solve says about the game
+    if (solutions < 0)
+        return RESULT_ERROR;
+    if (solutions == 0)
+        return RESULT_NONE;
+    if (solutions == 1)
+        return (SolutionLimit == 1)?(RESULT_SOME):(RESULT_UNIQUE);
+    return RESULT_MULTIPLE;
+}
+
+/*
+*  Parallel search
+*  The search tree is split in subtrees: until a node is deeper than SplitDepth its children are
+*  not explored by the thread that found them, but are pushed as tasks (a copy of the grid, where the heads of the
+*  paths can be found following the links) in the deque of the thread. Each worker takes the tasks from the bottom of its own deque,
+*  and when it is empty it steals them from the top of the deque of another worker, where the biggest subtrees are.
+*/
+struct _Task {
+    Cell *Grid; //Copy of the game grid at the root of the subtree
+    int Depth; //Depth of the root of the subtree
+    int Weight; //Solutions of the whole tree for each solution of the subtree (see Symmetries)
+};
+
+struct _Deque {
+    struct _Task *Tasks; //Circular buffer
+    int Bottom, Len, Size;
+    pthread_mutex_t Lock;
+};
+
+struct _Worker {
+    pthread_t Thread;
+    struct _Pool *Pool; //The workers of the search
+    GameData *Data; //The game to solve
+    struct _Options *Options; //The options of the search
+    Limit *Limit; //Counter of the solutions, shared by the workers
+    struct _Deque Deque;
+    unsigned Seed; //Used to choose the victim of the steals
+    long long Solutions; //Solutions found by this worker, or the error number
+    unsigned long long int TriedOutPaths, CutOffPaths;
+};
+
+struct _Pool { //Each parallel search has its own, so more of them can run at the same time
+    struct _Worker *Workers;
+    int Len;
+    long Pending; //Number of tasks pushed but not finished yet, when it's 0 the search is over
+};
+
+typedef struct _Task Task;
+typedef struct _Deque Deque;
+typedef struct _Worker Worker;
+typedef struct _Pool Pool;
+
+int Threads = 1; //Number of threads that solve the game
+__thread int SplitDepth = 8; //Nodes up to this depth hand out their children as tasks
+__thread Worker *Self = NULL; //The worker running in this thread, NULL if the game is solved by one thread
+
+void PushTask(Worker *w, Cell *grid, int depth, int weight){
+    Deque *d = &(w->Deque);
+    Task *tmp;
+    int i;
+    __sync_fetch_and_add(&(w->Pool->Pending), 1);
+    pthread_mutex_lock(&(d->Lock));
+    if (d->Len == d->Size){ //The deque is full, double its size
+        if ((tmp = malloc(2*d->Size*sizeof(Task))) == NULL){
+            fprintf(stderr, "Error allocating memory\n");
+            abort();
+        }
+        for (i = 0; i < d->Len; i++)
+            tmp[i] = d->Tasks[(d->Bottom + i) % d->Size];
+        free(d->Tasks);
+        d->Tasks = tmp;
+        d->Bottom = 0;
+        d->Size *= 2;
+    }
+    if ((tmp = &(d->Tasks[(d->Bottom + d->Len) % d->Size]), tmp->Grid = malloc(Width*Height*sizeof(Cell))) == NULL){
+        fprintf(stderr, "Error allocating memory\n");
+        abort();
+    }
+    memcpy(tmp->Grid, grid, Width*Height*sizeof(Cell));
+    tmp->Depth = depth;
+    tmp->Weight = weight;
+    d->Len++;
+    pthread_mutex_unlock(&(d->Lock));
+}
+
+int PopTask(Worker *w, Task *t){ //Takes the last pushed task, it's the smallest subtree
+    Deque *d = &(w->Deque);
+    int found = 0;
+    pthread_mutex_lock(&(d->Lock));
+    if (d->Len > 0){
+        d->Len--;
+        *t = d->Tasks[(d->Bottom + d->Len) % d->Size];
+        found = 1;
+    }
+    pthread_mutex_unlock(&(d->Lock));
+    return found;
+}
+
+int StealTask(Worker *w, Task *t){ //Takes the first pushed task, it's the biggest subtree
+    Deque *d = &(w->Deque);
+    int found = 0;
+    pthread_mutex_lock(&(d->Lock));
+    if (d->Len > 0){
+        *t = d->Tasks[d->Bottom];
+        d->Bottom = (d->Bottom + 1) % d->Size;
+        d->Len--;
+        found = 1;
+    }
+    pthread_mutex_unlock(&(d->Lock));
+    return found;
+}
+
+int GetTask(Worker *w, Task *t){
+    Pool *pool = w->Pool;
+    int i, victim;
+    for (;;){
+        if (PopTask(w, t))
+            return 1;
+        victim = rand_r(&(w->Seed)) % pool->Len;
+        for (i = 0; i < pool->Len; i++) //Try every other worker, starting from a random one
+            if ((&(pool->Workers[(victim + i) % pool->Len]) != w) && StealTask(&(pool->Workers[(victim + i) % pool->Len]), t))
+                return 1;
+        if (__sync_fetch_and_add(&(pool->Pending), 0) == 0)
+            return 0; //No task is left and no one is running, so no one can push other tasks
+        sched_yield();
+    }
+}
+
+/*
+*  Search
+*  The search is a depth first visit of the tree of the moves, but it is not recursive: the nodes from the root to the
+*  current one are kept in a stack allocated once, so the depth of the tree is limited only by the size of the grid.
+*  At each node a path not joined yet is chosen, and the moves are the four cells adjacent to its head: if one is
+*  empty the next piece of the path is put there, if it is the end endpoint of the path the path is joined.
+*  Every solution is found once whatever path is chosen, so the paths can be drawn in the order of the file, each
+*  one finished before the next one is started, or the path with the fewest moves can be chosen at each node, so
+*  a path which has only one way to go on is extended at once and a path which has none cuts off the node.
+*/
+struct _Frame {
+    int Head; //Cell of the head of the path chosen
+    int Path; //ID of the path chosen
+    int Reversed; //1 if the head and the tail of the path were swapped to extend it from the tail
+    int Move; //Next move to try out, 0 is x + 1, 1 is x - 1, 2 is y + 1, 3 is y - 1 (see Neighbours)
+    int Stop; //When Move gets here every move was tried out: 4, or the forced move + 1
+    int Forced; //1 if the only move of the node is forced, so the node is not a branch of the search
+    int Mark; //Mark of the reachability data before the last move
+    long long Solutions; //Solutions found in the subtrees of the moves already tried out, or the error number
+    unsigned long long Nodes; //TriedOutPaths when the node was started, so the size of its subtree is known
+    int Times; //Tuples of moves of the symmetry roots counted with the one of the node, 1 below or above them (see Symmetries)
+    int Weight; //Solutions of the whole tree for each solution of the subtree, the Times of the nodes up to this one
+};
+typedef struct _Frame Frame;
+
+const int MoveX[4] = {1, -1, 0, 0}, MoveY[4] = {0, 0, 1, -1};
+const int MoveLink[4] = {DIR_RIGHT, DIR_LEFT, DIR_DOWN, DIR_UP}, //Link from the cell of the node to the cell of the move
+MoveBack[4] = {DIR_LEFT, DIR_RIGHT, DIR_UP, DIR_DOWN}; //Link from the cell of the move to the cell of the node
+
+void InitNeighbours(){ //Computes the cells next to each cell of the game (see Neighbours)
+    int c, i, x, y;
+    if ((Neighbours = malloc(4*(Width*Height + 1)*sizeof(int))) == NULL){ //With the Sentinel
+        fprintf(stderr, "Error allocating memory\n");
+        abort();
+    }
+    for (c = 0; c < Width*Height; c++){
+        for (i = 0; i < 4; i++){
+            x = c % Width + MoveX[i];
+            y = c / Width + MoveY[i];
+            Neighbour(c, i) = ((x < 0) || (x >= Width) || (y < 0) || (y >= Height))?(Sentinel):(x + y*Width);
+        }
+    }
+    for (i = 0; i < 4; i++)
+        Neighbour(Sentinel, i) = Sentinel;
+}
+
+/*
+*  Symmetries
+*  A game whose endpoints are mapped on themselves by a rotation or a reflection of the grid (a path can be mapped on
+*  another one, swapping their colours) has the images of each solution as solutions too. The symmetries of the game
+*  are found by PrepareGame, with an orbit of endpoints (the images of an endpoint by every symmetry) which has at
+*  most one endpoint of each path: these are made the start endpoints of their paths (swapping the endpoints of a path
+*  changes nothing but the direction of the search), and the first nodes of the search extend them in order, one move
+*  each. Below them the moves made are a tuple of moves, one for each endpoint of the orbit, and a symmetry maps it on
+*  another tuple with the same number of solutions, so only the smallest tuple of each orbit is searched and its
+*  solutions are counted once for each tuple of the orbit. The counts are the same of the whole search, but the
+*  images of the solutions are not searched, so they are not drawn.
+*/
+struct _Symmetry {
+    int *Cells; //Image of each cell
+    int Moves[4]; //Image of each move
+    int Roots[MAX_SYMMETRIES]; //Index in SymmetryRoots of the image of each endpoint of the orbit
+};
+typedef struct _Symmetry Symmetry;
+
+__thread int UseSymmetry = 1; //0 if every solution is searched, even the images of the other ones
+
+static inline int MapCell(int t, int x, int y){ //Image of the cell by the transformation t of the grid
+    switch (t){
+        case 0: return x + y*Width;
+        case 1: return (Width - 1 - x) + y*Width;
+        case 2: return x + (Height - 1 - y)*Width;
+        case 3: return (Width - 1 - x) + (Height - 1 - y)*Width;
+        case 4: return y + x*Width; //The last ones only for square grids
+        case 5: return (Height - 1 - y) + x*Width;
+        case 6: return y + (Width - 1 - x)*Width;
+        default: return (Height - 1 - y) + (Width - 1 - x)*Width;
+    }
+}
+
+static int RootOrbit(unsigned group, const int *owner, int *orbit){ //The biggest orbit of the symmetries of the group with
+    //one endpoint for each path at most, returns its length or 0 if there is not any
+    int c, i, k, a, len, best = 0, tmp[MAX_SYMMETRIES];
+    for (c = 0; c < Width*Height; c++){
+        if (!owner[c])
+            continue;
+        for (len = 0, i = 0; i < Symmetries_Len; i++){
+            if (!(group & (1 << i)))
+                continue;
+            a = Symmetries[i].Cells[c];
+            for (k = 0; (k < len) && (owner[tmp[k]] != owner[a]); k++);
+            if (k == len)
+                tmp[len++] = a;
+            else if (tmp[k] != a)
+                break; //Both the endpoints of a path
+        }
+        if ((i == Symmetries_Len) && (len > best)){
+            best = len;
+            memcpy(orbit, tmp, len*sizeof(int));
+        }
+    }
+    return best;
+}
+
+void InitSymmetries(){ //Finds the transformations of the grid which map the endpoints of each path on the ones of a path
+    //The transformations of a move: the sign of x and y, and 1 if they are swapped
+    const int sx[8] = {1, -1, 1, -1, 1, -1, 1, -1}, sy[8] = {1, 1, -1, -1, 1, 1, -1, -1}, swap[8] = {0, 0, 0, 0, 1, 1, 1, 1};
+    int t, c, m, k, i, j, a, b, *owner, orbit[MAX_SYMMETRIES], len, product[MAX_SYMMETRIES][MAX_SYMMETRIES];
+    unsigned tmp, group, used;
+    Symmetry *g;
+    if (((Symmetries = malloc(MAX_SYMMETRIES*sizeof(Symmetry))) == NULL) ||
+    ((owner = calloc(Width*Height, sizeof(int))) == NULL)){
+        fprintf(stderr, "Error allocating memory\n");
+        abort();
+    }
+    for (k = 0; k < Points_Len; k++) //Path of each endpoint
+        owner[Points[k].x_start + Points[k].y_start*Width] = owner[Points[k].x_end + Points[k].y_end*Width] = k + 1;
+    Symmetries_Len = 0;
+    for (t = 0; t < ((Width == Height)?(8):(4)); t++){
+        for (k = 0; k < Points_Len; k++){
+            a = owner[MapCell(t, Points[k].x_start, Points[k].y_start)];
+            b = owner[MapCell(t, Points[k].x_end, Points[k].y_end)];
+            if (!a || (a != b))
+                break;
+        }
+        if ((k < Points_Len) || (t && !UseSymmetry))
+            continue;
+        g = &Symmetries[Symmetries_Len++];
+        if ((g->Cells = malloc(Width*Height*sizeof(int))) == NULL){
+            fprintf(stderr, "Error allocating memory\n");
+            abort();
+        }
+        for (c = 0; c < Width*Height; c++)
+            g->Cells[c] = MapCell(t, c % Width, c / Width);
+        for (m = 0; m < 4; m++){
+            a = sx[t]*(swap[t]?(MoveY[m]):(MoveX[m]));
+            b = sy[t]*(swap[t]?(MoveX[m]):(MoveY[m]));
+            for (k = 0; (MoveX[k] != a) || (MoveY[k] != b); k++);
+            g->Moves[m] = k;
+        }
+    }
+    for (i = 0; i < Symmetries_Len; i++) //The symmetry which is the product of two ones
+        for (j = 0; j < Symmetries_Len; j++)
+            for (k = 0; k < Symmetries_Len; k++){
+                for (c = 0; (c < Width*Height) && (Symmetries[k].Cells[c] == Symmetries[i].Cells[Symmetries[j].Cells[c]]); c++);
+                if (c == Width*Height)
+                    product[i][j] = k;
+            }
+    //A path can be mapped on itself reversed, so the orbits of the whole group can have both its endpoints: the
+    //biggest subgroup with an orbit which has not them is used (each one is generated by two symmetries at most)
+    SymmetryDepth = 0;
+    used = 1;
+    for (i = 1; i < Symmetries_Len; i++)
+        for (j = i; j < Symmetries_Len; j++){
+            group = (1 << i) | (1 << j) | 1;
+            do {
+                k = group;
+                for (a = 0; a < Symmetries_Len; a++)
+                    for (b = 0; b < Symmetries_Len; b++)
+                        if ((k & (1 << a)) && (k & (1 << b)))
+                            group |= 1 << product[a][b];
+            } while (group != k);
+            len = RootOrbit(group, owner, orbit);
+            if ((len > 0) && ((__builtin_popcount(group) > __builtin_popcount(used)) ||
+            ((group == used) && (len > SymmetryDepth)))){
+                used = group;
+                SymmetryDepth = len;
+                memcpy(SymmetryRoots, orbit, len*sizeof(int));
+            }
+        }
+    for (len = 0, i = 0; i < Symmetries_Len; i++){ //Only the subgroup is kept
+        if (used & (1 << i))
+            Symmetries[len++] = Symmetries[i];
+        else
+            free(Symmetries[i].Cells);
+    }
+    Symmetries_Len = len;
+    for (i = 0; i < SymmetryDepth; i++){
+        a = SymmetryRoots[i];
+        k = owner[a] - 1;
+        if (a != Points[k].x_start + Points[k].y_start*Width){ //The endpoint of the orbit becomes the start one
+            tmp = Points[k].x_start; Points[k].x_start = Points[k].x_end; Points[k].x_end = tmp;
+            tmp = Points[k].y_start; Points[k].y_start = Points[k].y_end; Points[k].y_end = tmp;
+        }
+        for (t = 0; t < Symmetries_Len; t++)
+            for (k = 0; k < SymmetryDepth; k++)
+                if (SymmetryRoots[k] == Symmetries[t].Cells[a])
+                    Symmetries[t].Roots[i] = k;
+    }
+    free(owner);
+}
+
+void FreeSymmetries(){
+    int i;
+    for (i = 0; i < Symmetries_Len; i++)
+        free(Symmetries[i].Cells);
+    free(Symmetries);
+}
+
+static inline int RootsOrbit(){ //Returns 0 if a symmetry maps the moves of the endpoints of the orbit on smaller ones,
+    //otherwise the number of their images, which have the same number of solutions
+    int i, k, c, d, images = 1, moves[MAX_SYMMETRIES], image[MAX_SYMMETRIES];
+    for (i = 0; i < SymmetryDepth; i++)
+        for (c = SymmetryRoots[i], moves[i] = 0; !(GameGrid[c].Links & MoveLink[moves[i]]); moves[i]++);
+    for (k = 1; k < Symmetries_Len; k++){
+        for (i = 0; i < SymmetryDepth; i++)
+            image[Symmetries[k].Roots[i]] = Symmetries[k].Moves[moves[i]];
+        for (i = 0; (i < SymmetryDepth) && (image[i] == moves[i]); i++);
+        if (i == SymmetryDepth)
+            continue; //The symmetry maps the moves on themselves
+        if (image[i] < moves[i])
+            return 0;
+        for (d = 1; d < k; d++){ //Counted once even if more symmetries give it
+            for (i = 0; i < SymmetryDepth; i++)
+                if (Symmetries[d].Moves[moves[i]] != image[Symmetries[d].Roots[i]])
+                    break;
+            if (i == SymmetryDepth)
+                break;
+        }
+        images += (d == k);
+    }
+    return images;
+}
+
+__thread Frame *Stack; //One frame for each piece, for each path and for each split of the regions, so it can't overflow
+__thread int BaseDepth = 0; //Depth in the whole tree of the root of the search
+__thread int Constrained = 0; //If 1 the path with the fewest moves is chosen at each node, otherwise the paths are drawn in order
+
+void AllocStack(){
+    if (((Stack = malloc(StackLen*sizeof(Frame))) == NULL) || ((Heads = malloc(Points_Len*sizeof(int))) == NULL) ||
+    ((Tails = malloc(Points_Len*sizeof(int))) == NULL) || ((PathLevel = malloc(Points_Len*sizeof(int))) == NULL)){
+        fprintf(stderr, "Error allocating memory\n");
+        abort();
+    }
+}
+
+void FreeStack(){
+    free(PathLevel);
+    free(Tails);
+    free(Heads);
+    free(Stack);
+}
+
+static int PathTip(int cell){ //Follows the links from an endpoint, returns the last cell of the piece of path
+    int i, from = -1, next;
+    do {
+        for (next = -1, i = 0; i < 4; i++)
+            if ((GameGrid[cell].Links & MoveLink[i]) && (cell + MoveX[i] + MoveY[i]*Width != from))
+                next = cell + MoveX[i] + MoveY[i]*Width;
+        if (next >= 0){
+            from = cell;
+            cell = next;
+        }
+    } while (next >= 0);
+    return cell;
+}
+
+void InitHeads(){ //Finds the heads and the tails of the paths following the links from their endpoints
+    int p, a, b;
+    Unfinished = 0;
+    GameGrid[Sentinel].Path = 1; //Not empty, and never a head or a tail (see Neighbours)
+    GameGrid[Sentinel].Links = GameGrid[Sentinel].Endpoint = GameGrid[Sentinel].End = 0;
+    for (p = 0; p < Points_Len; p++){
+        PathLevel[p] = 0;
+        a = PathTip(Points[p].x_start + Points[p].y_start*Width);
+        if (a == Points[p].x_end + Points[p].y_end*Width)
+            Heads[p] = Tails[p] = -1; //The path was joined
+        else {
+            b = PathTip(Points[p].x_end + Points[p].y_end*Width);
+            Heads[p] = GameGrid[a].End?(b):(a); //The End flag is on the tail
+            Tails[p] = GameGrid[a].End?(a):(b);
+            Unfinished++;
+        }
+    }
+}
+
+static inline void AddSolutions(Frame *f, long long solution){
+    if (f->Solutions < 0 || solution < 0) //if solutions contains already an error or if an error occurred in the subtree
+        f->Solutions = (f->Solutions < 0)?(f->Solutions):(solution); //store the error number
+    else if (__builtin_add_overflow(f->Solutions, solution, &(f->Solutions))) //Add the solutions found
+        f->Solutions = SOLUTIONS_OVERFLOW;
+}
+
+static inline long long Weighted(long long solution, int times){ //The solutions of a subtree counted for each of its images
+    long long weighted;
+    if (solution < 0)
+        return solution;
+    return __builtin_mul_overflow(solution, times, &weighted)?(SOLUTIONS_OVERFLOW):(weighted);
+}
+
+__thread int RootWeight = 1; //Weight of the root, more than 1 if the search is a task of a symmetric game
+
+/*
+*  Bidirectional search
+*  A path can be extended from both its endpoints: the head goes on from the start endpoint and the tail from the end
+*  one, and the path is joined when one of them moves on the other. The search always extends the head, the End flag
+*  is on the tail so it is the target of the moves, and a node which extends a path from the tail swaps them first,
+*  taking back the swap when the node ends. Each node extends the end with fewer moves, so an endpoint boxed in a
+*  corner is extended at once instead of after the whole path grown from the other endpoint.
+*/
+__thread int Bidirectional = 1; //0 if the paths are extended only from their start endpoints
+
+static inline void ReversePath(int p){ //Swaps the head and the tail of the path p
+    int tmp = Heads[p];
+    GameGrid[Tails[p]].End = 0;
+    GameGrid[tmp].End = 1;
+    Heads[p] = Tails[p];
+    Tails[p] = tmp;
+}
+
+#ifdef OPTIMIZATION
+/*
+*  Dead ends
+*  Every empty cell will be a piece of a path, so it must be linked to two of its neighbours: empty cells, heads or
+*  tails of the paths not joined yet. A cell loses these neighbours only when a path leaves its head or is joined to
+*  its tail, so at each move only the cells around the old head and the joined tail are checked.
+*/
+static inline int Open(Cell *grid, int cell){ //Checks if a path can still be linked to the cell
+    return IsEmpty(grid[cell]) || (Heads[grid[cell].Path - 1] == cell) || (Tails[grid[cell].Path - 1] == cell);
+}
+
+static inline int OpenAround(Cell *grid, int cell){ //Number of cells adjacent to the cell which are open
+    const int *n = &Neighbour(cell, 0);
+    return Open(grid, n[0]) + Open(grid, n[1]) + Open(grid, n[2]) + Open(grid, n[3]);
+}
+
+static inline int DeadEnd(Cell *grid, int cell){ //Checks if the cell is empty and can't be filled
+    return IsEmpty(grid[cell]) && (OpenAround(grid, cell) < 2);
+}
+
+static inline int DeadEndAround(Cell *grid, int cell){ //Checks the cells adjacent to the cell
+    const int *n = &Neighbour(cell, 0);
+    return DeadEnd(grid, n[0]) || DeadEnd(grid, n[1]) || DeadEnd(grid, n[2]) || DeadEnd(grid, n[3]);
+}
+
+/*
+*  Forced moves
+*  A move is forced when every solution makes it: the head (or the tail) of a path has only one move, or an empty cell
+*  next to it can be linked only to two cells, so it must be linked to it. Forced moves are made one after the other
+*  without branching, each one in a node with only that move, so the propagation is undone by the search like any
+*  other move. These nodes are counted in TriedOutPaths like the others (the statistics count them apart as forced), and
+*  the table is used only when no move is forced.
+*/
+static inline int ForcedMove(Cell *grid, int *move, int *tail){ //Finds a forced move, returns its path, -1 if there's
+    //none, -2 if a head or a tail can't move. tail is 1 if the move is of the tail
+    int e, p, i, cell, n, moves, last = 0, target;
+    for (e = 0; e < 2*Points_Len; e++){ //The head and the tail of each path
+        p = e >> 1;
+        *tail = e & 1;
+        if ((Heads[p] < 0) || (PathLevel[p] != SplitLevel) || (*tail && !Bidirectional))
+            continue; //Already joined, or of another region
+        cell = (*tail)?(Tails[p]):(Heads[p]);
+        target = (*tail)?(Heads[p]):(Tails[p]);
+        for (moves = 0, i = 0; i < 4; i++){
+            n = Neighbour(cell, i);
+            if (IsEmpty(grid[n])){
+                if (OpenAround(grid, n) == 2){
+                    *move = i;
+                    return p;
+                }
+                moves++;
+                last = i;
+            } else if (n == target){
+                moves++;
+                last = i;
+            }
+        }
+        if (moves == 0)
+            return -2;
+        if (moves == 1){
+            *move = last;
+            return p;
+        }
+    }
+    return -1;
+}
+#endif
+
+static inline int Moves(int cell, int target){ //Number of moves of a head or a tail to empty cells or to the other one
+    const int *n = &Neighbour(cell, 0);
+    Cell *grid = GameGrid;
+    return (IsEmpty(grid[n[0]]) || (n[0] == target)) + (IsEmpty(grid[n[1]]) || (n[1] == target)) +
+    (IsEmpty(grid[n[2]]) || (n[2] == target)) + (IsEmpty(grid[n[3]]) || (n[3] == target));
+}
+
+static inline int PathMoves(int p){ //Moves of the end of the path p with fewer moves, the one extended
+    int moves = Moves(Heads[p], Tails[p]), tail;
+    if (Bidirectional && ((tail = Moves(Tails[p], Heads[p])) < moves))
+        return tail;
+    return moves;
+}
+
+static inline int SelectPath(Frame *f){ //Chooses the path to extend, returns -1 if a path can't go on
+    int p, moves, best = -1, fewest = 5;
+    if (!Constrained){ //The first path not joined yet
+        for (p = 0; (Heads[p] < 0) || (PathLevel[p] != SplitLevel); p++){}
+        return p;
+    }
+    for (p = 0; p < Points_Len; p++){
+        if ((Heads[p] < 0) || (PathLevel[p] != SplitLevel) || ((moves = PathMoves(p)) >= fewest))
+            continue;
+        best = p;
+        fewest = moves;
+        if (moves <= 1)
+            break; //It can't get better than this
+    }
+    return (fewest == 0)?(-1):(best);
+}
+
+static inline int CutOff(Frame *f, int cause){ //The node f can't lead to a solution
+    CutOffPaths++;
+    StatCount(Prunes[cause], 1);
+    StatCount(DepthCutOffs[BaseDepth + (f - Stack)], 1);
+    return 0;
+}
+
+/*
+*  Independent regions
+*  When the empty cells are split in regions and each path not joined yet can go on only in one of them (both its
+*  ends touch it), the paths of a region never meet the ones of another region, so the solutions of the node are the
+*  products of the solutions of each group of regions (the regions are grouped when a path touches more of them).
+*  Instead of searching the regions of a group again for each solution of the others, each group is searched once on
+*  its own, from the one with the fewest cells, and as soon as one has no solutions the node is cut off. The search of
+*  a group is a nested search from the node above, which extends only the paths of its level and ends when they are
+*  joined and its regions are full; it can split its regions again one level deeper. Its positions are stored in the
+*  table with the key of its paths, so they don't match the positions of the whole search. The solutions of a group
+*  are only counted, so the regions are not split when the solutions are drawn or passed on (or saved in a checkpoint).
+*  The products easily go beyond the solutions a search could find one by one, so the counts are long long and one
+*  which doesn't fit is the error SOLUTIONS_OVERFLOW instead of a wrong number.
+*/
+__thread int SplitRegions = 1; //0 if the regions are never searched apart (-o)
+__thread int RegionsGoal; //Regions left when the regions of the search running are full
+__thread long long RegionSolutions; //Solutions found by the search of the regions running
+__thread unsigned long long RegionsKey = 0; //Key of the paths of the search running, xored with the hash
+
+long long Search(int base, int top);
+__thread int Probing = 0; //1 while the tree is estimated, the groups are probed instead of searched (see Estimate)
+__thread double ProbedPaths = 0; //Paths tried out by the groups, as estimated by their probes
+double ProbeTree(int base, int *solved);
+#define PROBE_TRIES 16 //Probes of a group before it is taken for one without solutions
+
+#ifdef OPTIMIZATION
+static int SolveRegions(Frame *f){ //Solves apart the groups of paths of different regions, returns 0 if they are not split
+    int label[4*Points_Len + 1], parent[4*Points_Len + 1], cells[4*Points_Len + 1], regions[4*Points_Len + 1],
+    first[Points_Len], level = SplitLevel, goal = UnfinishedGoal, regionsgoal = RegionsGoal, labels = 0, groups = 0,
+    capped = 0, solved, paths, best, p, i, j, k, g;
+    long long found = RegionSolutions, solutions, product = 1;
+    const int *start, *end;
+    unsigned long long hash = Hash ^ RegionsKey, key, regionskey = RegionsKey; //The hash of the position alone
+    if (!SplitRegions || Draw || (OnSolution != NULL) || (KeptSolutions != NULL) || (RegionsAlive < 2))
+        return 0;
+    for (p = 0; p < Points_Len; p++){ //The regions touched by both ends of each path, merged in groups
+        first[p] = -1;
+        if ((Heads[p] < 0) || (PathLevel[p] != SplitLevel))
+            continue;
+        start = &Neighbour(Heads[p], 0);
+        end = &Neighbour(Tails[p], 0);
+        for (i = 0; i < 4; i++){
+            if (Region[start[i]] == 0)
+                continue;
+            for (j = 0; (j < 4) && (Region[end[j]] != Region[start[i]]); j++){}
+            if (j == 4)
+                continue;
+            for (k = 0; (k < labels) && (label[k] != Region[start[i]]); k++){}
+            if (k == labels){
+                label[labels] = Region[start[i]];
+                parent[labels++] = k;
+                groups++;
+            }
+            if (first[p] < 0)
+                first[p] = k;
+            else if ((g = RegionGroup(parent, k)) != (j = RegionGroup(parent, first[p]))){
+                parent[g] = j;
+                groups--;
+            }
+        }
+    }
+    if (groups < 2)
+        return 0;
+    for (k = 0; k < labels; k++) //The cells and the regions of each group are counted in its first label
+        cells[k] = regions[k] = 0;
+    for (k = 0; k < labels; k++){
+        cells[RegionGroup(parent, k)] += RegionSize[label[k]];
+        regions[RegionGroup(parent, k)]++;
+    }
+    StatCount(RegionSplits, 1);
+    f->Nodes = TriedOutPaths;
+    while ((product > 0) && !SearchLimit->Stopped){
+        for (best = -1, k = 0; k < labels; k++) //The smallest group left
+            if ((parent[k] == k) && (regions[k] > 0) && ((best < 0) || (cells[k] < cells[best])))
+                best = k;
+        if (best < 0)
+            break; //Every group was solved
+        for (paths = 0, key = 0, p = 0; p < Points_Len; p++){
+            if ((first[p] >= 0) && (RegionGroup(parent, first[p]) == best)){
+                PathLevel[p] = level + 1;
+                paths++;
+                if (Table != NULL)
+                    key ^= PathKeys[p];
+            }
+        }
+        SplitLevel = level + 1;
+        UnfinishedGoal = Unfinished - paths;
+        RegionsGoal = RegionsAlive - regions[best];
+        RegionSolutions = 0;
+        RegionsKey = key;
+        Hash = hash ^ key;
+        if (Probing){ //The first probe estimates the group, the others only look for a solution
+            ProbedPaths += ProbeTree(f - Stack + 1, &solved);
+            for (i = 1; (i < PROBE_TRIES) && !solved; i++)
+                ProbeTree(f - Stack + 1, &solved);
+            solutions = solved;
+        } else
+            solutions = Search(f - Stack + 1, f - Stack + 1);
+        for (p = 0; p < Points_Len; p++)
+            if (PathLevel[p] == level + 1)
+                PathLevel[p] = level;
+        if (solutions < 0)
+            product = solutions;
+        else if (__builtin_mul_overflow(product, solutions, &product)) //The groups multiply counts far beyond an int
+            product = SOLUTIONS_OVERFLOW;
+        //With a limit a group stops at SolutionLimit solutions, the product isn't smaller unless a group has none
+        capped |= SolutionLimit && (solutions >= SolutionLimit);
+        regions[best] = 0;
+    }
+    SplitLevel = level;
+    UnfinishedGoal = goal;
+    RegionsGoal = regionsgoal;
+    RegionSolutions = found;
+    RegionsKey = regionskey;
+    Hash = hash ^ regionskey;
+    if (SearchLimit->Stopped)
+        product = 0; //The search is over, the solutions of the groups stopped were not counted
+    else if ((Table != NULL) && !capped && !Probing)
+        TableStore(product, TriedOutPaths - f->Nodes);
+    if (level == 0)
+        FoundSolutions(Weighted(product, f->Weight));
+    f->Solutions = Weighted(product, f->Times);
+    return 1;
+}
+#endif
+
+static inline int EnterNode(Frame *f){ //Starts a node choosing the path to extend, returns 0 if it has nothing to try out
+#ifdef OPTIMIZATION
+    Frame *parent = f - 1;
+    int c, m = 0, dead, tail = 0;
+#endif
+    int p, depth = BaseDepth + (f - Stack);
+    f->Move = 0;
+    f->Stop = 4;
+    f->Forced = 0;
+    f->Reversed = 0;
+    f->Solutions = 0;
+    f->Times = 1;
+    f->Weight = (f == Stack)?(RootWeight):((f - 1)->Weight);
+    StatCount(DepthNodes[depth], 1);
+    if ((depth == SymmetryDepth) && (depth > 0)){ //Every endpoint of the orbit was extended
+        if (!(f->Times = RootsOrbit()))
+            return 0; //Its solutions are counted with the ones of a smaller tuple of moves
+        f->Weight *= f->Times;
+    }
+#ifdef OPTIMIZATION /*This optimizes the algorithm avoiding it continue to solve an unsolvable position
+    *The prupose of the game is to fill the grid joining dots with lines wich can't cross each other,
+    *so if an empty cell can't be linked to two cells, or a path can't be joined any more, or a region
+    *of empty cells can't be filled by any path, the function ends and returns 0 (no solution).
+    *The regions are kept up to date by RegionsFill at each move.
+    */
+    StatStart(dead_ends);
+    if (f == Stack){ //Root of the search, every cell is checked
+        for (dead = 0, c = 0; (c < Width*Height) && !dead; c++)
+            dead = DeadEnd(GameGrid, c);
+    } else if (parent->Move == 0)
+        dead = 0; //Root of the search of a group of regions, its parent was checked (see Independent regions)
+    else {
+        m = parent->Move - 1;
+        dead = DeadEndAround(GameGrid, parent->Head) || DeadEndAround(GameGrid, Neighbour(parent->Head, m));
+    }
+    StatStop(dead_ends, TIME_DEAD_ENDS);
+    if (dead)
+        return CutOff(f, PRUNE_DEAD_END);
+    StatStart(stranded);
+    dead = RegionsStranded();
+    StatStop(stranded, TIME_REACHABILITY);
+    if (dead)
+        return CutOff(f, PRUNE_STRANDED);
+    StatStart(forced);
+    p = (depth < SymmetryDepth)?(-1):(ForcedMove(GameGrid, &m, &tail)); //The roots of the symmetries are extended first
+    StatStop(forced, TIME_MOVES);
+    if (p >= 0){ //The move is made at once, without branching
+        StatCount(PathForced[p], 1);
+        if (tail)
+            ReversePath(p);
+        f->Reversed = tail;
+        f->Path = p + 1;
+        f->Head = Heads[p];
+        f->Move = m;
+        f->Stop = m + 1;
+        f->Forced = 1;
+        f->Nodes = TriedOutPaths;
+        TriedOutPaths++;
+        return 1;
+    }
+    if (p == -2)
+        return CutOff(f, PRUNE_NO_MOVES);
+#endif
+    if ((Table != NULL) && (depth >= SymmetryDepth) && TableLookup(&(f->Solutions))){
+        StatCount(TableHits, 1);
+        if (SplitLevel == 0) //The solutions of a group of regions are counted by the node which split them
+            FoundSolutions(Weighted(f->Solutions, f->Weight));
+        f->Solutions = Weighted(f->Solutions, f->Times);
+        return 0; //The subtree was already searched
+    }
+#ifdef OPTIMIZATION
+    if ((depth >= SymmetryDepth) && SolveRegions(f))
+        return 0; //The regions were searched apart
+#endif
+    StatStart(select);
+    p = (depth < SymmetryDepth)?(GameGrid[SymmetryRoots[depth]].Path - 1):(SelectPath(f));
+    StatStop(select, TIME_MOVES);
+    if (p < 0)
+        return CutOff(f, PRUNE_NO_MOVES);
+    StatCount(PathNodes[p], 1);
+    if (Bidirectional && (depth >= SymmetryDepth) && (Moves(Tails[p], Heads[p]) < Moves(Heads[p], Tails[p]))){
+        ReversePath(p); //The tail has fewer moves
+        f->Reversed = 1;
+    }
+    f->Path = p + 1;
+    f->Head = Heads[p];
+#ifdef ANIMATION
+    OfferSnapshot();
+#endif
+    f->Nodes = TriedOutPaths;
+    TriedOutPaths++; //Increase the number of tried out path
+    return 1;
+}
+
+static inline void UndoMove(Cell *grid, Frame *f){ //Takes back the last move of the node
+    int m = f->Move - 1, n = Neighbour(f->Head, m);
+    Cell *c = &grid[n];
+    grid[f->Head].Links &= ~MoveLink[m];
+    Heads[f->Path - 1] = f->Head;
+    if (c->End){ //The path was joined to its tail
+        c->Links &= ~MoveBack[m];
+        Tails[f->Path - 1] = n;
+        Unfinished++;
+        if (Table != NULL)
+            Hash ^= HeadKeys[(f->Path - 1)*Width*Height + f->Head] ^ HeadKeys[(f->Path - 1)*Width*Height + n];
+        return;
+    }
+    if (Table != NULL)
+        Hash ^= CellKey(f->Path, n) ^ HeadKeys[(f->Path - 1)*Width*Height + f->Head] ^ HeadKeys[(f->Path - 1)*Width*Height + n];
+#ifdef OPTIMIZATION
+    StatStart(unfill);
+    RegionsUndo(f->Mark);
+    StatStop(unfill, TIME_REACHABILITY);
+#endif
+    c->Path = 0;
+    c->Links = 0;
+}
+
+/*
+*  Self touch
+*  In the solutions of well made games a path never runs next to its own cells but the ones before and after it: a
+*  path which turns back along itself could be shortened. With this option (-x) a move which puts a path next to one of
+*  its cells, which is not the cell it comes from or its tail, is not made, so these subtrees are cut off at once. A
+*  head can move next to its tail, but then the tail is the only cell it can go on to: the two cells are next to each
+*  other, so they must be joined. Only the solutions without self touches are counted, whatever the order of the
+*  moves, so it is meant for the games checked for uniqueness (-n 2) or made by the generator, where it cuts a large
+*  part of the tree.
+*/
+static inline int SelfTouch(Cell *grid, Frame *f, int cell){ //Checks if the move to the empty cell of the node puts
+    //its path next to itself
+    int i, n;
+    for (i = 0; i < 4; i++)
+        if (Neighbour(f->Head, i) == Tails[f->Path - 1])
+            return 1; //The head is next to its tail, it can only be joined to it
+    for (i = 0; i < 4; i++){
+        n = Neighbour(cell, i);
+        //The Sentinel has the Path of the first path, but it is never part of it
+        if ((grid[n].Path == f->Path) && !grid[n].End && (n != f->Head) && (n != Sentinel))
+            return 1;
+    }
+    return 0;
+}
+
+static inline int MakeMove(Cell *grid, Frame *f, int m){ //Makes the move m of the node, returns 0 if it can't be made
+    int n = Neighbour(f->Head, m); //The Sentinel outside the grid, which is neither empty nor a tail
+    Cell *c = &grid[n];
+    if (IsEmpty(*c)){ //Chek if the cell is free
+        if (NoSelfTouch && SelfTouch(grid, f, n)){
+            CutOffPaths++;
+            StatCount(Prunes[PRUNE_SELF_TOUCH], 1);
+            return 0;
+        }
+        //if it is we start filling it with the next piece of the path
+        c->Path = f->Path;
+        c->Links = MoveBack[m]; //Linked to the previous piece
+        grid[f->Head].Links |= MoveLink[m];
+        Heads[f->Path - 1] = n;
+        if (Table != NULL)
+            Hash ^= CellKey(f->Path, n) ^ HeadKeys[(f->Path - 1)*Width*Height + f->Head] ^ HeadKeys[(f->Path - 1)*Width*Height + n];
+#ifdef OPTIMIZATION
+        StatStart(fill);
+        f->Mark = RegionsFill(n);
+        StatStop(fill, TIME_REACHABILITY);
+#endif
+    } else if ((c->Path == f->Path) && (c->End)){
+        //If it is not free, but contains the tail of the path
+        grid[f->Head].Links |= MoveLink[m]; //The cell was joined to the tail
+        c->Links |= MoveBack[m];
+        Heads[f->Path - 1] = Tails[f->Path - 1] = -1;
+        if (Table != NULL)
+            Hash ^= HeadKeys[(f->Path - 1)*Width*Height + f->Head] ^ HeadKeys[(f->Path - 1)*Width*Height + n];
+        Unfinished--;
+    } else
+        return 0;
+    if (!f->Forced)
+        StatCount(PathMoves[f->Path - 1], 1);
+    return 1;
+}
+
+long long StoppedSolutions(Frame *stack, int top){ //Solutions found by a search stopped at the node top
+    for (; top > 0; top--)
+        AddSolutions(&stack[top - 1], Weighted(stack[top].Solutions, stack[top].Times));
+    return Weighted(stack[0].Solutions, stack[0].Times);
+}
+
+#ifdef OPTIMIZATION
+static long long LeaveRegions(Frame *stack, int base, int top){ //Takes back the moves of the search of a group of regions
+    //stopped at the node top, returns its solutions
+    for (; top >= base; top--){
+        if (stack[top].Reversed)
+            ReversePath(stack[top].Path - 1);
+        if (top > base)
+            UndoMove(GameGrid, &stack[top - 1]);
+    }
+    return RegionSolutions;
+}
+#endif
+
+/*
+*  Checkpoints
+*  A long search can save its state in a file from time to time, and when it is interrupted (SIGINT or SIGTERM), so
+*  it can be resumed from there. The state is the stack of the search: for each node the path chosen, its head, the
+*  next move to try out and the solutions found in the subtrees already searched, with the paths tried out and cut
+*  off. The move in progress at each node is Move - 1, so the grid, the heads and the reachability data are rebuilt
+*  making these moves again from the root, and the search goes on as if it was never stopped: the final result is the
+*  same of a search never stopped (the paths tried out too, if the table is not used, because the table is not saved).
+*  Only the search with one thread is saved, and the file is removed when the search ends.
+*/
+#define CHECKPOINT_STEPS 65536 //Steps of the search between two checks of the clock
+__thread int ClockSteps = 0; //Steps since the last check, counted by the searches of the regions too
+
+const char *CheckpointFile = NULL; //The file of the checkpoints, NULL if they are disabled
+int CheckpointInterval = 300; //Seconds between two checkpoints
+time_t NextCheckpoint;
+volatile sig_atomic_t CheckpointSignal = 0; //Signal received, the checkpoint is saved and the program ends
+
+void CheckpointHandler(int sig){
+    CheckpointSignal = sig;
+}
+
+void SaveCheckpoint(Frame *stack, int top){ //Writes the state in a new file and then replaces the old one with it
+    char name[4096];
+    FILE *F;
+    int i;
+    snprintf(name, sizeof(name), "%s.tmp", CheckpointFile);
+    if ((F = fopen(name, "w")) == NULL){
+        fprintf(stderr, "Error writing the checkpoint %s\n", name);
+        return;
+    }
+    fprintf(F, "FollowMe checkpoint 4\n%d %d %d %d %d %d\n", Width, Height, Points_Len, Constrained, Bidirectional, NoSelfTouch);
+    for (i = 0; i < Points_Len; i++)
+        fprintf(F, "%d %d %d %d\n", Points[i].x_start, Points[i].y_start, Points[i].x_end, Points[i].y_end);
+    fprintf(F, "%llu %llu %d\n", TriedOutPaths, CutOffPaths, top);
+    for (i = 0; i <= top; i++)
+        fprintf(F, "%d %d %d %d %d %d %lld %llu %d %d %d\n", stack[i].Head % Width, stack[i].Head / Width, stack[i].Path,
+        stack[i].Move, stack[i].Stop, stack[i].Forced, stack[i].Solutions, stack[i].Nodes, stack[i].Times, stack[i].Weight,
+        stack[i].Reversed);
+    if ((fclose(F) != 0) || (rename(name, CheckpointFile) != 0))
+        fprintf(stderr, "Error writing the checkpoint %s\n", CheckpointFile);
+}
+
+int LoadCheckpoint(Frame *stack){ //Reads the state and makes the moves again, returns the top of the stack
+    FILE *F;
+    int i, width, height, paths, constrained, bidirectional, noselftouch, top, x, y, error = 0;
+    unsigned xs, ys, xe, ye;
+    if ((F = fopen(CheckpointFile, "r")) == NULL){
+        fprintf(stderr, "Error opening the checkpoint %s\n", CheckpointFile);
+        abort();
+    }
+    if ((fscanf(F, "FollowMe checkpoint 4 %d %d %d %d %d %d", &width, &height, &paths, &constrained, &bidirectional,
+    &noselftouch) != 6) || (width != Width) || (height != Height) || (paths != Points_Len) || (constrained != Constrained) ||
+    (bidirectional != Bidirectional) || (noselftouch != NoSelfTouch))
+        error = 1; //The game or the order of the search are different
+    for (i = 0; (i < Points_Len) && !error; i++)
+        error = (fscanf(F, "%u %u %u %u", &xs, &ys, &xe, &ye) != 4) || (xs != Points[i].x_start) ||
+        (ys != Points[i].y_start) || (xe != Points[i].x_end) || (ye != Points[i].y_end);
+    if (!error)
+        error = (fscanf(F, "%llu %llu %d", &TriedOutPaths, &CutOffPaths, &top) != 3) || (top < 0) ||
+        (top > Width*Height + Points_Len);
+    for (i = 0; (i <= top) && !error; i++){
+        error = (fscanf(F, "%d %d %d %d %d %d %lld %llu %d %d %d", &x, &y, &(stack[i].Path), &(stack[i].Move),
+        &(stack[i].Stop), &(stack[i].Forced), &(stack[i].Solutions), &(stack[i].Nodes), &(stack[i].Times),
+        &(stack[i].Weight), &(stack[i].Reversed)) != 11) || (stack[i].Times < 1) || (stack[i].Times > Symmetries_Len) ||
+        (stack[i].Weight < stack[i].Times) || (stack[i].Weight > Symmetries_Len) ||
+        (x < 0) || (x >= Width) || (y < 0) || (y >= Height) ||
+        (stack[i].Path < 1) || (stack[i].Path > Points_Len) || (stack[i].Move < 0) || (stack[i].Move > stack[i].Stop) ||
+        (stack[i].Stop > 4) || (stack[i].Reversed & ~1) || (Heads[stack[i].Path - 1] < 0);
+        if (error)
+            break;
+        stack[i].Head = x + y*Width;
+        if (stack[i].Reversed)
+            ReversePath(stack[i].Path - 1); //As the node did when it was started
+        error = (Heads[stack[i].Path - 1] != stack[i].Head) ||
+        ((i < top) && ((stack[i].Move == 0) || !MakeMove(GameGrid, &stack[i], stack[i].Move - 1)));
+    }
+    fclose(F);
+    if (error){
+        fprintf(stderr, "Error: the checkpoint %s is not valid or it is of another game or of other options\n", CheckpointFile);
+        abort();
+    }
+    for (i = 0; i <= top; i++) //The solutions already found count for the limit
+        FoundSolutions(Weighted(stack[i].Solutions, (i > 0)?(stack[i - 1].Weight):(1)));
+    return top;
+}
+
+/*
+*  Progress
+*  A long search can print on stderr every few seconds (-v) how far it got: the paths tried out, how many each second,
+*  and the part of the tree searched, found from the move in progress at each node of the stack. Each node is split in
+*  equal parts, one for each move it can make, so its part searched is the one of the moves already tried out and the
+*  part searched of the move in progress. To know the moves of each node, the moves of the stack are taken back and
+*  made again, as LoadCheckpoint does. The time left is the time taken over the part searched times the part left: it
+*  is rough while the first moves near the root are searched, because their subtrees are not the same size, and it
+*  gets better as the search goes on. Only the search with one thread is followed.
+*/
+int ProgressInterval = 0; //Seconds between two lines of the progress, 0 if it is not printed
+time_t NextProgress;
+struct timeval ProgressStart; //When the search started or was resumed
+double ProgressBase; //Part of the tree searched when the search was resumed from a checkpoint
+
+static inline int CanMove(Cell *grid, Frame *f, int m){ //Checks if MakeMove can make the move m of the node
+    int n = Neighbour(f->Head, m);
+    if (IsEmpty(grid[n]))
+        return !NoSelfTouch || !SelfTouch(grid, f, n);
+    return (grid[n].Path == f->Path) && grid[n].End;
+}
+
+double SearchedPart(Frame *stack, int top){ //Part of the tree searched before the node top and its next move
+    double part = 0, size = 1;
+    int i, m, moves, done, last, counted = 1;
+    for (i = top; i >= 0; i--){ //Back to the root
+        if (stack[i].Reversed)
+            ReversePath(stack[i].Path - 1);
+        if ((i > 0) && (stack[i - 1].Move > 0))
+            UndoMove(GameGrid, &stack[i - 1]);
+    }
+    for (i = 0; i <= top; i++){
+        if (stack[i].Reversed)
+            ReversePath(stack[i].Path - 1);
+        if ((i < top) && (stack[i].Move == 0))
+            counted = 0; //The node whose regions are searched apart, the nodes above are of its groups
+        if (counted && !stack[i].Forced){
+            last = (i < top)?(stack[i].Move - 1):(stack[i].Move); //The move in progress, the next one at the top
+            for (moves = done = 0, m = 0; m < 4; m++){
+                if (CanMove(GameGrid, &stack[i], m)){
+                    moves++;
+                    done += m < last;
+                }
+            }
+            if (moves > 0){
+                size /= moves;
+                part += size*done;
+            }
+        }
+        if ((i < top) && (stack[i].Move > 0))
+            MakeMove(GameGrid, &stack[i], stack[i].Move - 1);
+    }
+    return part;
+}
+
+void TimeString(double seconds, char buffer[32]){ //Writes the seconds as hours:minutes:seconds
+    long long s = seconds;
+    snprintf(buffer, 32, "%lld:%02lld:%02lld", s/3600, (s/60) % 60, s % 60);
+}
+
+void PrintProgress(Frame *stack, int top){
+    struct timeval now;
+    double elapsed, part = SearchedPart(stack, top);
+    char taken[32], left[32] = "?";
+    gettimeofday(&now, NULL);
+    elapsed = (now.tv_sec - ProgressStart.tv_sec) + (now.tv_usec - ProgressStart.tv_usec)/1e6;
+    TimeString(elapsed, taken);
+    if (part > ProgressBase)
+        TimeString(elapsed/(part - ProgressBase)*(1 - part), left);
+    fprintf(stderr, "Searched %.3f%% in %s, %llu paths tried out (%.0f each second), about %s left\n", 100*part, taken,
+    TriedOutPaths, (elapsed > 0)?(TriedOutPaths/elapsed):(0), left);
+}
+
+long long Search(int base, int top){ //this is the most important funcion in the game, it returns the number of solutions
+    //base is the root of the search in the stack, 0 but for the search of a group of regions (see Independent regions),
+    //top is the index of the current node: base to start from the root, or the top of the stack rebuilt by LoadCheckpoint
+    long long solution;
+    int m;
+    Cell *grid = GameGrid;
+    Frame *stack = Stack, *f;
+    if ((top == base) && !EnterNode(&stack[base]))
+        return stack[base].Solutions;
+    while (1){
+        if (SearchLimit->Stopped) //The limit was reached or the search was cancelled, the grid is left as it is
+            return (base > 0)?(0):(StoppedSolutions(stack, top));
+        if (((CheckpointFile != NULL) || ProgressInterval) && (++ClockSteps == CHECKPOINT_STEPS)){
+            ClockSteps = 0;
+            if ((CheckpointFile != NULL) && (CheckpointSignal || (time(NULL) >= NextCheckpoint))){
+                SaveCheckpoint(stack, top);
+                NextCheckpoint = time(NULL) + CheckpointInterval;
+                if (CheckpointSignal){
+                    fprintf(stderr, "The search was interrupted, it can be resumed from %s\n", CheckpointFile);
+                    exit(128 + CheckpointSignal);
+                }
+            }
+            if (ProgressInterval && (time(NULL) >= NextProgress)){
+                PrintProgress(stack, top);
+                NextProgress = time(NULL) + ProgressInterval;
+            }
+        }
+        f = &stack[top];
+        if (f->Move == f->Stop){ //Every move was tried out, go back to the parent node
+            //The subtrees handed out as tasks are not counted here, and above the symmetry roots only the smallest
+            //tuples of moves are, so these nodes are not stored
+            if ((Table != NULL) && !f->Forced && (f->Solutions >= 0) && ((Self == NULL) || (SplitLevel > 0) ||
+            (BaseDepth + top >= SplitDepth)) && (BaseDepth + top >= SymmetryDepth))
+                TableStore(f->Solutions, TriedOutPaths - f->Nodes);
+            solution = Weighted(f->Solutions, f->Times);
+            if (f->Reversed)
+                ReversePath(f->Path - 1);
+            if (top == base)
+                return solution; //it returns the number of solution or the error number
+            f = &stack[--top];
+            UndoMove(grid, f);
+            AddSolutions(f, solution);
+            continue;
+        }
+        m = f->Move++;
+        if (!MakeMove(grid, f, m))
+            continue;
+        if (Unfinished == UnfinishedGoal){
+#ifdef OPTIMIZATION
+            if (SplitLevel > 0){ //The paths of the group were joined, its regions must be full
+                solution = (RegionsAlive == RegionsGoal);
+                RegionSolutions += solution;
+                AddSolutions(f, solution);
+                UndoMove(grid, f);
+                if (SolutionLimit && (RegionSolutions >= SolutionLimit))
+                    return LeaveRegions(stack, base, top); //The product of the groups reaches the limit
+                continue;
+            }
+#endif
+            //Every point was joined, check the solution (there must not be any empty cells), and then print it
+            StatStart(check);
+            solution = CheckGame();
+            StatStop(check, TIME_CHECK);
+            AddSolutions(f, solution);
+            FoundSolutions(solution*f->Weight);
+            UndoMove(grid, f);
+            continue;
+        }
+        if ((Self != NULL) && !f->Forced && (SplitLevel == 0) && (BaseDepth + top < SplitDepth)){
+            //Near the root the subtree is handed out as a task, its solutions are counted by who will solve it
+            PushTask(Self, grid, BaseDepth + top + 1, f->Weight);
+            UndoMove(grid, f);
+        } else if (EnterNode(&stack[top + 1]))
+            top++; //Go on with the search from the child
+        else {
+            AddSolutions(f, stack[top + 1].Solutions);
+            UndoMove(grid, f);
+#ifdef OPTIMIZATION
+            if ((SplitLevel > 0) && (stack[top + 1].Solutions > 0)){ //From the table or from groups of regions
+                RegionSolutions += stack[top + 1].Solutions;
+                if (SolutionLimit && (RegionSolutions >= SolutionLimit))
+                    return LeaveRegions(stack, base, top);
+            }
+#endif
+        }
+    }
+}
+
+/*
+*  Estimate
+*  How long a search will take can be guessed before making it, estimating the size of its tree as Knuth did: a probe
+*  goes down from the root choosing at random one of the moves which can be made at each node, and if the nodes it goes
+*  through have d1, d2, d3... moves the tree has about 1 + d1 + d1*d2 + ... nodes. The mean of many probes (-z N) is an
+*  unbiased estimate of the paths tried out by the search. The probes make the moves and the checks of the search with
+*  the same options, so the nodes cut off are left out as the search leaves them out. When a probe splits the regions
+*  each group is probed in turn and the node counts their estimates. The search doesn't go on with the other groups when
+*  one has no solutions, so neither does the probe: a group is probed again until a probe gets to one of its solutions,
+*  and after PROBE_TRIES probes which don't it is taken for a group without solutions. Probing every group instead would
+*  count the big groups after a small one without solutions, which the search never searches, and make the estimate too
+*  big by orders of magnitude; a group with few solutions taken for one without makes it too small, by much less. The
+*  table is empty while the tree is probed, so the estimate is of the search without it. The trees of these games are
+*  very unbalanced, so the standard error of the estimate, found from the spread of the probes, is large with few
+*  probes, and the estimate of a few probes is more often too small than too big.
+*/
+int EstimateProbes = 0; //Probes of the estimate of the tree, 0 if the game is searched (-z)
+__thread unsigned long long ProbeState; //The random choices of the probes, the same at every run
+
+double ProbeTree(int base, int *solved){ //Makes a probe from the node base, returns its estimate of the paths tried
+    //out, solved is 1 if the probe got to a solution (of the group of regions, if base is the root of one)
+    Cell *grid = GameGrid;
+    Frame *stack = Stack, *f;
+    unsigned long long tried = TriedOutPaths, before;
+    double nodes, weight = 1, paths = ProbedPaths, probed = ProbedPaths;
+    int moves[4], d, m, top, entered;
+    top = base - !EnterNode(&stack[base]); //The last node entered
+    nodes = (TriedOutPaths - tried) + (ProbedPaths - probed); //1 for a node, or the probes of its groups
+    *solved = (top < base) && (stack[base].Solutions > 0);
+    while (top >= base){
+        f = &stack[top];
+        for (d = 0, m = f->Move; m < f->Stop; m++){ //The moves which can be made
+            f->Move = m + 1;
+            if (MakeMove(grid, f, m)){
+                moves[d++] = m;
+                UndoMove(grid, f);
+            }
+        }
+        if (d == 0)
+            break;
+        m = moves[RandomKey(&ProbeState) % d];
+        f->Move = m + 1;
+        MakeMove(grid, f, m);
+        weight *= d;
+        if (Unfinished > UnfinishedGoal){
+            before = TriedOutPaths;
+            probed = ProbedPaths;
+            entered = EnterNode(&stack[top + 1]);
+            nodes += weight*((TriedOutPaths - before) + (ProbedPaths - probed));
+            if (entered){
+                top++;
+                continue;
+            }
+            *solved = stack[top + 1].Solutions > 0; //Its groups of regions were probed, or it was cut off
+        }
+#ifdef OPTIMIZATION
+        else //Only the probes of the groups need to know, whose paths must fill their regions
+            *solved = (SplitLevel > 0) && (RegionsAlive == RegionsGoal);
+#endif
+        UndoMove(grid, f); //The probe ends with this move
+        break;
+    }
+    for (; top >= base; top--){ //Back to the node base, as the search does
+        if (stack[top].Reversed)
+            ReversePath(stack[top].Path - 1);
+        if (top > base)
+            UndoMove(grid, &stack[top - 1]);
+    }
+    TriedOutPaths = tried; //The probe only counts them, with the estimates of its groups
+    ProbedPaths = paths;
+    return nodes;
+}
+
+double EstimateTree(int probes, double *error){ //Returns the estimate of the paths tried out by the search and its
+    //standard error, the game must be ready to be solved and the grid is left as it was
+    Limit limit = {0, 0}, *searchlimit = SearchLimit;
+    unsigned long long cutoff = CutOffPaths;
+    double nodes, sum = 0, squares = 0, mean;
+    int solutionlimit = SolutionLimit, solved, i;
+    SearchLimit = &limit;
+    SolutionLimit = 0; //The solutions met by the probes don't count
+    Probing = 1;
+    ProbeState = 1;
+    InitHeads();
+    if (Table != NULL)
+        InitHash();
+#ifdef OPTIMIZATION
+    InitRegions();
+#endif
+    BaseDepth = 0;
+    RootWeight = 1;
+    for (i = 0; i < probes; i++){
+        nodes = ProbeTree(0, &solved);
+        sum += nodes;
+        squares += nodes*nodes;
+    }
+    Probing = 0;
+    SearchLimit = searchlimit;
+    SolutionLimit = solutionlimit;
+    CutOffPaths = cutoff;
+    mean = sum/probes;
+    *error = (probes > 1)?(sqrt(fmax(squares - probes*mean*mean, 0)/(probes - 1)/probes)):(0);
+    return mean;
+}
+
+/*
+*  Options
+*  The options of the search are private to each thread like the game, so games with different options can be
+*  solved at the same time (see Library). The threads started by a search, a batch or the generator copy them from
+*  the thread which started them.
+*/
+struct _Options {
+    int Draw, Constrained, SolutionLimit, SplitDepth, TableMB, ReplaceAlways, UseSymmetry, Bidirectional, NoSelfTouch, SplitRegions;
+    SolutionCallback OnSolution;
+    void *OnSolutionData;
+};
+typedef struct _Options Options;
+
+void SaveOptions(Options *o){
+    o->Draw = Draw;
+    o->Constrained = Constrained;
+    o->SolutionLimit = SolutionLimit;
+    o->SplitDepth = SplitDepth;
+    o->TableMB = TableMB;
+    o->ReplaceAlways = ReplaceAlways;
+    o->UseSymmetry = UseSymmetry;
+    o->Bidirectional = Bidirectional;
+    o->NoSelfTouch = NoSelfTouch;
+    o->SplitRegions = SplitRegions;
+    o->OnSolution = OnSolution;
+    o->OnSolutionData = OnSolutionData;
+}
+
+void LoadOptions(const Options *o){
+    Draw = o->Draw;
+    Constrained = o->Constrained;
+    SolutionLimit = o->SolutionLimit;
+    SplitDepth = o->SplitDepth;
+    TableMB = o->TableMB;
+    ReplaceAlways = o->ReplaceAlways;
+    UseSymmetry = o->UseSymmetry;
+    Bidirectional = o->Bidirectional;
+    NoSelfTouch = o->NoSelfTouch;
+    SplitRegions = o->SplitRegions;
+    OnSolution = o->OnSolution;
+    OnSolutionData = o->OnSolutionData;
+}
+
+/*
+*  Buffers
+*  The grid and the buffers of the search depend only on the size of the game, so in batch mode each thread
+*  allocates them again only when a game doesn't fit in the ones of the last game it solved.
+*/
+__thread int BufferWidth = 0, BufferHeight = 0, BufferPaths = 0; //Size of the game the buffers were allocated for
+
+void AllocBuffers(){
+    if ((GameGrid = malloc((Width*Height + 1)*sizeof(Cell))) == NULL){ //With the Sentinel
+        fprintf(stderr, "Error allocating memory\n");
+        abort();
+    }
+    AllocStack();
+#ifdef OPTIMIZATION
+    AllocRegions();
+#endif
+#ifdef STATISTICS
+    AllocStatistics();
+#endif
+    if (Draw)
+        AllocFrame();
+}
+
+void FreeBuffers(){
+    FreeFrame();
+#ifdef STATISTICS
+    FreeStatistics();
+#endif
+#ifdef OPTIMIZATION
+    FreeRegions();
+#endif
+    FreeStack();
+    free(GameGrid);
+}
+
+void ReserveBuffers(){ //Allocates the buffers for the game, keeping the ones already allocated if it fits in them
+    int width = Width, height = Height, paths = Points_Len;
+    if ((BufferWidth > 0) && (Width*Height <= BufferWidth*BufferHeight) && (Height <= BufferHeight) &&
+    (Points_Len <= BufferPaths))
+        return;
+    if (BufferWidth > 0){ //They are freed with the size they were allocated for
+        Width = BufferWidth;
+        Height = BufferHeight;
+        Points_Len = BufferPaths;
+        FreeBuffers();
+        Width = width;
+        Height = height;
+        Points_Len = paths;
+    }
+    AllocBuffers();
+    BufferWidth = Width;
+    BufferHeight = Height;
+    BufferPaths = Points_Len;
+}
+
+void ReleaseBuffers(){ //Frees the buffers kept by ReserveBuffers
+    if (BufferWidth == 0)
+        return;
+    Width = BufferWidth;
+    Height = BufferHeight;
+    Points_Len = BufferPaths;
+    FreeBuffers();
+    BufferWidth = BufferHeight = BufferPaths = 0;
+}
+
+void *WorkerMain(void *arg){
+    Worker *w = arg;
+    Task t;
+    long long solution;
+    Self = w;
+    SearchLimit = w->Limit;
+    LoadOptions(w->Options);
+    LoadGameData(w->Data);
+    AllocBuffers();
+    TriedOutPaths = CutOffPaths = 0;
+    while (GetTask(w, &t)){
+        memcpy(GameGrid, t.Grid, Width*Height*sizeof(Cell));
+        free(t.Grid);
+        if (SearchLimit->Stopped){ //The tasks left are thrown away
+            __sync_fetch_and_sub(&(w->Pool->Pending), 1);
+            continue;
+        }
+        InitHeads();
+        if (Table != NULL)
+            InitHash();
+#ifdef OPTIMIZATION
+        InitRegions();
+#endif
+        BaseDepth = t.Depth;
+        RootWeight = t.Weight;
+        solution = Weighted(Search(0, 0), t.Weight); //The Times of the nodes above the task are not counted by them
+        if (w->Solutions < 0 || solution < 0)
+            w->Solutions = (w->Solutions < 0)?(w->Solutions):(solution);
+        else if (__builtin_add_overflow(w->Solutions, solution, &(w->Solutions)))
+            w->Solutions = SOLUTIONS_OVERFLOW;
+        __sync_fetch_and_sub(&(w->Pool->Pending), 1); //Only now, so the tasks pushed by this one are already counted
+    }
+    w->TriedOutPaths = TriedOutPaths;
+    w->CutOffPaths = CutOffPaths;
+#ifdef STATISTICS
+    AddStatistics();
+#endif
+    FreeBuffers();
+    return NULL;
+}
+
+long long SolveParallel(int threads){
+    long long solution = 0;
+    int i;
+    GameData data;
+    Options options;
+    Pool pool;
+    Worker *Workers;
+    SaveGameData(&data);
+    SaveOptions(&options);
+    if ((Workers = malloc(threads*sizeof(Worker))) == NULL){
+        fprintf(stderr, "Error allocating memory\n");
+        abort();
+    }
+    pool.Workers = Workers;
+    pool.Len = threads;
+    pool.Pending = 0;
+    for (i = 0; i < threads; i++){
+        Workers[i].Pool = &pool;
+        Workers[i].Data = &data;
+        Workers[i].Options = &options;
+        Workers[i].Limit = SearchLimit;
+        Workers[i].Deque.Size = 64;
+        Workers[i].Deque.Bottom = Workers[i].Deque.Len = 0;
+        if ((Workers[i].Deque.Tasks = malloc(Workers[i].Deque.Size*sizeof(Task))) == NULL){
+            fprintf(stderr, "Error allocating memory\n");
+            abort();
+        }
+        pthread_mutex_init(&(Workers[i].Deque.Lock), NULL);
+        Workers[i].Seed = i + 1;
+        Workers[i].Solutions = 0;
+        Workers[i].TriedOutPaths = Workers[i].CutOffPaths = 0;
+    }
+    PushTask(&Workers[0], GameGrid, 0, 1); //The root of the tree
+    for (i = 0; i < threads; i++){
+        if (pthread_create(&(Workers[i].Thread), NULL, WorkerMain, &Workers[i])){
+            fprintf(stderr, "Error creating the threads\n");
+            abort();
+        }
+    }
+    for (i = 0; i < threads; i++){
+        pthread_join(Workers[i].Thread, NULL);
+        if (solution < 0 || Workers[i].Solutions < 0)
+            solution = (solution < 0)?(solution):(Workers[i].Solutions);
+        else if (__builtin_add_overflow(solution, Workers[i].Solutions, &solution))
+            solution = SOLUTIONS_OVERFLOW;
+        TriedOutPaths += Workers[i].TriedOutPaths; //Sum the paths tried out by every worker
+        CutOffPaths += Workers[i].CutOffPaths;
+    }
+    for (i = 0; i < threads; i++){ //Only now, the workers still running can try to steal from the ones which ended
+        pthread_mutex_destroy(&(Workers[i].Deque.Lock));
+        free(Workers[i].Deque.Tasks);
+    }
+    free(Workers);
+    return solution;
+}
+
+long long Solve(int threads, Limit *limit){ //Solves the game with the given number of threads, at most SolutionLimit solutions are counted
+    //The search stops when limit->Stopped is set, by the limit of the solutions or by who started it
+    long long solution;
+    int top = 0;
+    if (Points_Len == 0)
+        return 0; //Could not solve
+    SearchLimit = limit;
+    if (threads > 1)
+        solution = SolveParallel(threads);
+    else {
+        InitHeads();
+        if (Table != NULL)
+            InitHash();
+#ifdef OPTIMIZATION
+        InitRegions();
+#endif
+        if (CheckpointFile != NULL){
+            if (access(CheckpointFile, F_OK) == 0){ //Resume the search saved
+                top = LoadCheckpoint(Stack);
+                fprintf(stderr, "The search is resumed from %s\n", CheckpointFile);
+            }
+            NextCheckpoint = time(NULL) + CheckpointInterval;
+        }
+        if (ProgressInterval){
+            gettimeofday(&ProgressStart, NULL);
+            ProgressBase = (top > 0)?(SearchedPart(Stack, top)):(0);
+            NextProgress = time(NULL) + ProgressInterval;
+        }
+        RootWeight = 1;
+        solution = Search(0, top);
+        if (CheckpointFile != NULL)
+            unlink(CheckpointFile); //The search ended, there is nothing to resume
+#ifdef STATISTICS
+        AddStatistics();
+#endif
+    }
+    SearchLimit = NULL;
+    //The threads and the table can find some solutions more at the same time
+    return (SolutionLimit && (solution > SolutionLimit))?(SolutionLimit):(solution);
+}
+
+int CheckPoints(){ //Checks the endpoints of the game, returns the number of valid paths before the first wrong one
+    //Each endpoint marks its cell with its path, so an endpoint on a cell already marked is found at once
+    unsigned x, y, *owner;
+    if ((owner = calloc(Width*Height, sizeof(unsigned))) == NULL){
+        fprintf(stderr, "Error allocating memory\n");
+        abort();
+    }
+    for (x = 0; x < Points_Len; x++){
+        //Checking thath the endpoins are inside the grid size
+        if ((Points[x].x_start >= Width) || (Points[x].x_end >= Width) || (Points[x].y_start >= Height) || (Points[x].y_end >= Height)){
+            fprintf(stderr, "Error: data conflict\nThe endpoints of the path %d must be inside the game grid, check th grid's size\n", x+1);
+            break;
+        }
+        //Cheking that the endpoints of the pats are differents
+        if ((Points[x].x_start == Points[x].x_end) && (Points[x].y_start == Points[x].y_end)){
+            fprintf(stderr, "Error: data conflict\nThe two endpoints of the path %d must be differents\n", x+1);
+            break;
+        }
+        //Checking that no endpoints are in the same cell
+        if ((y = owner[Points[x].x_start + Points[x].y_start*Width]) || (y = owner[Points[x].x_end + Points[x].y_end*Width])){
+            fprintf(stderr, "Error: data conflict\nThe endpoints of the path %d must be different from the path %d's one\n", x+1, y);
+            break;
+        }
+        owner[Points[x].x_start + Points[x].y_start*Width] = owner[Points[x].x_end + Points[x].y_end*Width] = x + 1;
+    }
+    free(owner);
+    return x;
+}
+
+int ReadGame(const char *name){ //Reads the game from the file, returns -1 if it can't be read or it is not valid
+    unsigned x;
+    FILE * F;
+    //Open the file
+    if ((F = fopen(name, "r")) == NULL){
+        fprintf(stderr, "Error opening file\nMaybe the file does not exist\n");
+        return -1;
+    }
+    //Start reading the file
+    //The first two numbers are the width and the heigt of the game grid
+    if (fscanf(F, "%d %d", &Width, &Height) != 2){ //if fscanf reads less than 2 numbers there is an error in the file
+        fprintf(stderr, "Error reading file, data corrupted\nI wasn't able to read the size of the game\n");
+        fclose(F);
+        return -1;
+    }
+    //the third number written in the file is the number of lines
+    if (fscanf(F, "%d", &Points_Len) != 1){
+        fprintf(stderr, "Error reading file, data corrupted\nI wasn't able to read the number of paths\n");
+        fclose(F);
+        return -1;
+    }
+    if (Points_Len > MAX_PATHS){
+        fprintf(stderr, "Error: too many paths\nThe game can have at most %d paths\n", MAX_PATHS);
+        fclose(F);
+        return -1;
+    }
+    //Allocating memory for points
+    if ((Points = malloc(Points_Len * sizeof(PathPoint))) == NULL){
+        fprintf(stderr, "Error allocating memory\n");
+        abort();
+    }
+    for (x = 0; x < Points_Len; x++){
+        //reading the coordinates of the endpoints of the paths
+        if (fscanf(F, "%d\t%d\t%d\t%d", &(Points[x].x_start), &(Points[x].y_start), &(Points[x].x_end), &(Points[x].y_end)) != 4) {
+            fprintf(stderr, "Error reading file, data corrupted\nI wasn't able to read one or more of the coordinates of the endpoints of the path %d\n", x+1);
+            break;
+        }
+    }
+    fclose(F);
+    if ((x < Points_Len) || (CheckPoints() < Points_Len)){
+        free(Points);
+        return -1;
+    }
+    //Finish reading the file!
+    return 0;
+}
+
+void PrepareGame(){ //Puts the endpoints in the grid and computes the data used by the search
+    unsigned x;
+    //Cause of there can be different size game it's better to use a multidimensional array,
+    //but the code to manage a multidimensional dynamic array is to long and difficoult, so the easiest
+    //way to do so is using a monodimensional dynamic array
+
+    //Reset the GameGrid Array
+    //The GameGrid Array is mono-dimensional, but it is used as a multidimensional array
+    //The reset of the whole array it is faster with a single cycle instead of two nested cycles
+    for (x = 0; x < Width*Height; x++){
+        GameGrid[x].Path = GameGrid[x].Links = GameGrid[x].Endpoint = GameGrid[x].End = 0;
+    }
+    InitNeighbours();
+    InitSymmetries(); //It can swap the endpoints of some paths
+    //For a description of the format of the grid's cell go where I defined the struct _Cell
+    for (x = 0; x < Points_Len; x++){
+        GameCell(Points[x].x_start, Points[x].y_start).Path     = (x+1);
+        GameCell(Points[x].x_start, Points[x].y_start).Endpoint = 1;
+        GameCell(Points[x].x_end  , Points[x].y_end  ).Path     = (x+1);
+        GameCell(Points[x].x_end  , Points[x].y_end  ).Endpoint = 1;
+        GameCell(Points[x].x_end  , Points[x].y_end  ).End      = 1;
+    }
+    if (TableMB > 0)
+        AllocTable();
+}
+
+void ReleaseGame(){ //Frees the game and the data computed by PrepareGame
+    FreeSymmetries();
+    free(Neighbours);
+    if (Table != NULL){
+        FreeTable();
+        Table = NULL;
+    }
+    free(Points);
+}
+
+/*
+*  Corpus
+*  Many games can be packed in a binary corpus (.fmc), read through mmap so a game is found at once without reading
+*  the ones before it. The file begins with a header of 16 bytes: "FMCORPUS", the version (1) and the number of
+*  games; then comes the offset from the beginning of the file of each game, and then the games. A game is its width,
+*  its height and its number of paths (one byte each), the length of its name (two bytes) and the name (the file it
+*  was made from, without the final 0), and then the 4 coordinates of the endpoints of each path (one byte each). The
+*  numbers are little endian. The corpus is made by MakeCorpus from text games.
+*/
+#define CORPUS_MAGIC "FMCORPUS"
+#define CORPUS_VERSION 1
+#define CORPUS_HEADER 16
+
+struct _Corpus {
+    const unsigned char *Data; //The whole file, mapped
+    size_t Size;
+    unsigned Len; //Number of games
+};
+typedef struct _Corpus Corpus;
+
+static inline unsigned long long ReadLE(const unsigned char *p, int bytes){ //Reads a little endian number
+    unsigned long long n = 0;
+    while (bytes-- > 0)
+        n = (n << 8) | p[bytes];
+    return n;
+}
+
+Corpus *OpenCorpus(const char *name){ //Maps the corpus, returns NULL if it can't be read or it is not a corpus
+    Corpus *c;
+    struct stat info;
+    void *data;
+    int fd;
+    if ((fd = open(name, O_RDONLY)) < 0){
+        fprintf(stderr, "Error opening the corpus %s\n", name);
+        return NULL;
+    }
+    if ((fstat(fd, &info) < 0) || (info.st_size < CORPUS_HEADER) ||
+    ((data = mmap(NULL, info.st_size, PROT_READ, MAP_PRIVATE, fd, 0)) == MAP_FAILED)){
+        fprintf(stderr, "Error reading the corpus %s\n", name);
+        close(fd);
+        return NULL;
+    }
+    close(fd); //The mapping stays
+    if ((c = malloc(sizeof(Corpus))) == NULL){
+        fprintf(stderr, "Error allocating memory\n");
+        abort();
+    }
+    c->Data = data;
+    c->Size = info.st_size;
+    c->Len = ReadLE(c->Data + 12, 4);
+    if (memcmp(c->Data, CORPUS_MAGIC, 8) || (ReadLE(c->Data + 8, 4) != CORPUS_VERSION) ||
+    ((c->Size - CORPUS_HEADER)/8 < c->Len)){
+        fprintf(stderr, "Error: %s is not a corpus of version %d\n", name, CORPUS_VERSION);
+        munmap(data, c->Size);
+        free(c);
+        return NULL;
+    }
+    return c;
+}
+
+void CloseCorpus(Corpus *c){
+    munmap((void *)c->Data, c->Size);
+    free(c);
+}
+
+const unsigned char *CorpusGame(const Corpus *c, unsigned i){ //Returns the game, NULL if it doesn't fit in the file
+    unsigned long long offset = ReadLE(c->Data + CORPUS_HEADER + 8*(size_t)i, 8);
+    const unsigned char *game = c->Data + offset;
+    if ((offset > c->Size - 5) || (offset + 5 + ReadLE(game + 3, 2) + 4*game[2] > c->Size))
+        return NULL;
+    return game;
+}
+
+int CorpusName(const Corpus *c, unsigned i, char *name, int size){ //Copies the name of the game, returns its length
+    const unsigned char *game = CorpusGame(c, i);
+    int len = 0;
+    if (game != NULL){
+        if ((len = ReadLE(game + 3, 2)) >= size)
+            len = size - 1;
+        memcpy(name, game + 5, len);
+    }
+    name[len] = '\0';
+    return len;
+}
+
+int LoadCorpusGame(const Corpus *c, unsigned i){ //Loads the game as ReadGame does, returns -1 if it is not valid
+    const unsigned char *game = CorpusGame(c, i), *p;
+    unsigned x;
+    if (game == NULL){
+        fprintf(stderr, "Error: the game %u of the corpus is corrupted\n", i);
+        return -1;
+    }
+    Width = game[0];
+    Height = game[1];
+    Points_Len = game[2];
+    if ((Points = malloc((Points_Len + 1)*sizeof(PathPoint))) == NULL){
+        fprintf(stderr, "Error allocating memory\n");
+        abort();
+    }
+    for (x = 0, p = game + 5 + ReadLE(game + 3, 2); x < Points_Len; x++, p += 4){
+        Points[x].x_start = p[0];
+        Points[x].y_start = p[1];
+        Points[x].x_end = p[2];
+        Points[x].y_end = p[3];
+    }
+    if ((Width == 0) || (Height == 0) || (CheckPoints() < Points_Len)){
+        free(Points);
+        return -1;
+    }
+    return 0;
+}
+
+/*
+*  Frontier counting
+*  Counts the solutions without searching them (-f). The cells are swept row by row, and the solutions of the cells
+*  swept are grouped by their frontier: the link going down from each cell of the last row swept and the one going
+*  right from the last cell swept. Each link is labelled with the path it belongs to, if its piece of path reaches
+*  an endpoint, or with the piece of path it belongs to, so the two ends of a piece without an endpoint are known.
+*  Solutions with the same frontier go on in the same ways, so they are merged in one state of a hash map which
+*  keeps how many they are; the labels of the pieces are renumbered in the order they are met, so equal frontiers
+*  get equal keys. An endpoint has one link and an empty cell two, a piece can't close on itself and the pieces of
+*  two different paths can't be joined. The states depend only on the width of the frontier, so the grid is swept
+*  along its longer side, and the count of a game whose solutions are too many for the search is found in seconds.
+*  The counts are 128 bit numbers.
+*/
+typedef unsigned __int128 Count;
+
+struct _Frontier { //Hash map of the states, with open addressing
+    unsigned short *Keys; //Len labels for each state: 0 no link, 1 to Points_Len a path, then the pieces
+    Count *Counts; //Solutions with that frontier, 0 if the slot is empty
+    size_t *Slots; //The slots used, so the states are visited and cleared without looking at the empty ones
+    size_t Size, Used;
+    int Len;
+};
+typedef struct _Frontier Frontier;
+
+int FrontierCounting = 0; //-f counts the solutions with the frontiers instead of the search
+__thread size_t FrontierStates; //Most states of a step of the last count
+
+void AllocFrontier(Frontier *f, int len, size_t size){
+    f->Len = len;
+    f->Size = size;
+    f->Used = 0;
+    if (((f->Keys = malloc(size*len*sizeof(unsigned short))) == NULL) || ((f->Counts = calloc(size, sizeof(Count))) == NULL) ||
+    ((f->Slots = malloc((size/2 + 1)*sizeof(size_t))) == NULL)){
+        fprintf(stderr, "Error allocating memory\n");
+        abort();
+    }
+}
+
+void FreeFrontier(Frontier *f){
+    free(f->Keys);
+    free(f->Counts);
+    free(f->Slots);
+}
+
+static inline size_t FrontierHash(const unsigned short *key, int len){
+    unsigned long long h = 0xCBF29CE484222325ULL;
+    int i;
+    for (i = 0; i < len; i++)
+        h = (h ^ key[i])*0x100000001B3ULL;
+    return h ^ (h >> 32);
+}
+
+void AddState(Frontier *f, const unsigned short *key, Count n);
+
+void GrowFrontier(Frontier *f){ //Doubles the slots, the states are added again
+    Frontier old = *f;
+    size_t i;
+    AllocFrontier(f, old.Len, old.Size*2);
+    for (i = 0; i < old.Used; i++)
+        AddState(f, &old.Keys[old.Slots[i]*old.Len], old.Counts[old.Slots[i]]);
+    FreeFrontier(&old);
+}
+
+void AddState(Frontier *f, const unsigned short *key, Count n){
+    size_t i = FrontierHash(key, f->Len) & (f->Size - 1);
+    while (f->Counts[i]){
+        if (!memcmp(&f->Keys[i*f->Len], key, f->Len*sizeof(unsigned short))){
+            f->Counts[i] += n;
+            return;
+        }
+        i = (i + 1) & (f->Size - 1);
+    }
+    memcpy(&f->Keys[i*f->Len], key, f->Len*sizeof(unsigned short));
+    f->Counts[i] = n;
+    f->Slots[f->Used] = i;
+    if (2*(++f->Used) > f->Size) //At most half full, so the probes are short
+        GrowFrontier(f);
+}
+
+static inline void Relabel(unsigned short *key, int len, unsigned short from, unsigned short to){ //The other end of a piece
+    int i;
+    for (i = 0; i < len; i++)
+        if (key[i] == from)
+            key[i] = to;
+}
+
+void AddLinks(Frontier *f, const unsigned short *key, int x, unsigned short down, unsigned short right, Count n){
+    //Adds the state with the links of the cell swept, the pieces renumbered from Points_Len + 1 in order
+    unsigned short state[f->Len], map[f->Len + 1], next = Points_Len + 1;
+    int i;
+    memcpy(state, key, sizeof(state));
+    state[x] = down;
+    state[f->Len - 1] = right;
+    memset(map, 0, sizeof(map));
+    for (i = 0; i < f->Len; i++){
+        if (state[i] > Points_Len){
+            if (map[state[i] - Points_Len - 1] == 0)
+                map[state[i] - Points_Len - 1] = next++;
+            state[i] = map[state[i] - Points_Len - 1];
+        }
+    }
+    AddState(f, state, n);
+}
+
+Count FrontierCount(){ //Counts the solutions of the game loaded
+    //The grid is swept in rows of cols cells, the columns of the game if it is higher than wide, else its rows
+    int rows = (Width > Height)?(Width):(Height), cols = (Width > Height)?(Height):(Width), len = cols + 1;
+    int x, y, i, in;
+    unsigned short *ends, key[len], up, left, piece = Points_Len + len; //piece isn't used by the states
+    Frontier current, next, swap;
+    Count n, solutions = 0;
+    size_t s;
+    if ((ends = calloc(rows*cols, sizeof(unsigned short))) == NULL){
+        fprintf(stderr, "Error allocating memory\n");
+        abort();
+    }
+    for (i = 0; i < Points_Len; i++){ //Path of each endpoint
+        ends[(Width > Height)?(Points[i].x_start*cols + Points[i].y_start):(Points[i].y_start*cols + Points[i].x_start)] = i + 1;
+        ends[(Width > Height)?(Points[i].x_end*cols + Points[i].y_end):(Points[i].y_end*cols + Points[i].x_end)] = i + 1;
+    }
+    AllocFrontier(&current, len, 1024);
+    AllocFrontier(&next, len, 1024);
+    memset(key, 0, sizeof(key));
+    AddState(&current, key, 1);
+    FrontierStates = 1;
+    for (y = 0; y < rows; y++){
+        for (x = 0; x < cols; x++){
+            for (s = 0; s < current.Used; s++){
+                n = current.Counts[current.Slots[s]];
+                memcpy(key, &current.Keys[current.Slots[s]*len], sizeof(key));
+                up = key[x];
+                left = key[cols];
+                in = (up != 0) + (left != 0);
+                key[x] = key[cols] = 0;
+                if (ends[y*cols + x]){ //An endpoint has one link
+                    if (in == 2)
+                        continue;
+                    if (in == 1){
+                        if (up < left)
+                            up = left;
+                        if (up > Points_Len) //The other end of the piece reaches the endpoint
+                            Relabel(key, len, up, ends[y*cols + x]);
+                        else if (up != ends[y*cols + x])
+                            continue;
+                        AddLinks(&next, key, x, 0, 0, n);
+                        continue;
+                    }
+                    if (y + 1 < rows)
+                        AddLinks(&next, key, x, ends[y*cols + x], 0, n);
+                    if (x + 1 < cols)
+                        AddLinks(&next, key, x, 0, ends[y*cols + x], n);
+                } else if (in == 2){ //An empty cell has two links, here the two pieces are joined
+                    if ((up <= Points_Len) && (left <= Points_Len)){
+                        if (up != left) //Two paths
+                            continue;
+                    } else if (up == left) //A loop
+                        continue;
+                    else if (up <= Points_Len)
+                        Relabel(key, len, left, up);
+                    else
+                        Relabel(key, len, up, left);
+                    AddLinks(&next, key, x, 0, 0, n);
+                } else if (in == 1){ //The piece goes on
+                    if (up < left)
+                        up = left;
+                    if (y + 1 < rows)
+                        AddLinks(&next, key, x, up, 0, n);
+                    if (x + 1 < cols)
+                        AddLinks(&next, key, x, 0, up, n);
+                } else if ((y + 1 < rows) && (x + 1 < cols)) //A new piece
+                    AddLinks(&next, key, x, piece, piece, n);
+            }
+            if (next.Used > FrontierStates)
+                FrontierStates = next.Used;
+            swap = current;
+            current = next;
+            next = swap;
+            for (s = 0; s < next.Used; s++)
+                next.Counts[next.Slots[s]] = 0;
+            next.Used = 0;
+        }
+    }
+    for (s = 0; s < current.Used; s++) //Every link is inside the grid, so only the empty frontier is left
+        solutions += current.Counts[current.Slots[s]];
+    FreeFrontier(&current);
+    FreeFrontier(&next);
+    free(ends);
+    return solutions;
+}
+
+char *CountString(Count n, char *buffer){ //Writes the count in decimal, the buffer must have 40 chars
+    char *p = buffer + 39;
+    *p = '\0';
+    do {
+        *--p = '0' + (int)(n % 10);
+        n /= 10;
+    } while (n);
+    return p;
+}
+
+/*
+*  Batch mode
+*  Solves a list of games: each thread of the pool takes the next game of the list, solves it alone and prints one
+*  line with the name of the file, the result (none, unique, multiple, some or error, see Result), the number of solutions, the
+*  paths tried out, the time taken in seconds and the paths cut off, separated by tabs. The solutions are not drawn.
+*/
+struct _BatchFile {
+    char *Name;
+    Corpus *Corpus; //NULL if the file is a text game
+    int First; //Number in the list of its first game
+};
+typedef struct _BatchFile BatchFile;
+
+BatchFile *BatchFiles; //The files of the games, text games and corpora
+int BatchFiles_Len, BatchFiles_Size;
+int BatchGames = 0; //Number of games in the list, a corpus has many
+int BatchNext = 0; //Next game to solve
+
+int IsCorpus(const char *name){
+    size_t len = strlen(name);
+    return (len >= 4) && !strcmp(name + len - 4, ".fmc");
+}
+
+void AddBatchFile(const char *name){
+    BatchFile *f;
+    if (BatchFiles_Len == BatchFiles_Size){
+        BatchFiles_Size = (BatchFiles_Size == 0)?(64):(BatchFiles_Size*2);
+        if ((BatchFiles = realloc(BatchFiles, BatchFiles_Size*sizeof(BatchFile))) == NULL){
+            fprintf(stderr, "Error allocating memory\n");
+            abort();
+        }
+    }
+    f = &BatchFiles[BatchFiles_Len++];
+    if ((f->Name = strdup(name)) == NULL){
+        fprintf(stderr, "Error allocating memory\n");
+        abort();
+    }
+    f->Corpus = NULL;
+    if (IsCorpus(name) && ((f->Corpus = OpenCorpus(name)) == NULL))
+        abort();
+}
+
+int CompareNames(const void *a, const void *b){
+    return strcmp(((const BatchFile *)a)->Name, ((const BatchFile *)b)->Name);
+}
+
+void AddBatchDirectory(const char *name){ //Adds every .dat and .fmc file of the directory, sorted by name
+    DIR *dir;
+    struct dirent *entry;
+    char *path;
+    size_t len;
+    int first = BatchFiles_Len;
+    if ((dir = opendir(name)) == NULL){
+        fprintf(stderr, "Error opening the directory %s\n", name);
+        abort();
+    }
+    while ((entry = readdir(dir)) != NULL){
+        len = strlen(entry->d_name);
+        if ((len < 4) || (strcmp(entry->d_name + len - 4, ".dat") && !IsCorpus(entry->d_name)))
+            continue;
+        if ((path = malloc(strlen(name) + len + 2)) == NULL){
+            fprintf(stderr, "Error allocating memory\n");
+            abort();
+        }
+        sprintf(path, "%s/%s", name, entry->d_name);
+        AddBatchFile(path);
+        free(path);
+    }
+    closedir(dir);
+    qsort(&BatchFiles[first], BatchFiles_Len - first, sizeof(BatchFile), CompareNames);
+}
+
+void ReadBatchList(FILE *F){ //Adds the files listed one for each line
+    char line[4096];
+    size_t len;
+    while (fgets(line, sizeof(line), F) != NULL){
+        len = strlen(line);
+        while ((len > 0) && ((line[len - 1] == '\n') || (line[len - 1] == '\r')))
+            line[--len] = '\0';
+        if (len > 0)
+            AddBatchFile(line);
+    }
+}
+
+void ReadBatchArguments(int argc, char *argv[]){ //The arguments are files or directories, the list is read from stdin if there's none or one is -
+    struct stat info;
+    int i;
+    if (argc == 0)
+        ReadBatchList(stdin);
+    for (i = 0; i < argc; i++){
+        if (!strcmp(argv[i], "-"))
+            ReadBatchList(stdin);
+        else if (!stat(argv[i], &info) && S_ISDIR(info.st_mode))
+            AddBatchDirectory(argv[i]);
+        else
+            AddBatchFile(argv[i]);
+    }
+    for (i = 0, BatchGames = 0; i < BatchFiles_Len; i++){ //The games are numbered in the order of the files
+        BatchFiles[i].First = BatchGames;
+        BatchGames += (BatchFiles[i].Corpus == NULL)?(1):(BatchFiles[i].Corpus->Len);
+    }
+}
+
+void FreeBatchFiles(){
+    int i;
+    for (i = 0; i < BatchFiles_Len; i++){
+        if (BatchFiles[i].Corpus != NULL)
+            CloseCorpus(BatchFiles[i].Corpus);
+        free(BatchFiles[i].Name);
+    }
+    free(BatchFiles);
+}
+
+int LoadBatchGame(int game, char *name, int size){ //Loads the game of the list and writes its name, returns -1 if it is not valid
+    int low = 0, high = BatchFiles_Len - 1, mid;
+    BatchFile *f;
+    while (low < high){ //The last file whose first game is not after this one
+        mid = (low + high + 1)/2;
+        if (BatchFiles[mid].First <= game)
+            low = mid;
+        else
+            high = mid - 1;
+    }
+    f = &BatchFiles[low];
+    if (f->Corpus == NULL){
+        snprintf(name, size, "%s", f->Name);
+        return ReadGame(f->Name);
+    }
+    if (CorpusName(f->Corpus, game - f->First, name, size) == 0) //A game without a name is called after its place
+        snprintf(name, size, "%s:%d", f->Name, game - f->First);
+    return LoadCorpusGame(f->Corpus, game - f->First);
+}
+
+void *BatchMain(void *arg){ //arg are the options of the search
+    long long solution;
+    int i;
+    struct timeval start, end;
+    const char *result;
+    char name[4096], count[40];
+    double estimate, error;
+    Count n;
+    Limit limit;
+    LoadOptions(arg);
+    while ((i = __sync_fetch_and_add(&BatchNext, 1)) < BatchGames){
+        gettimeofday(&start, NULL);
+        limit.Found = limit.Stopped = 0;
+        TriedOutPaths = CutOffPaths = 0;
+        result = NULL;
+        if (LoadBatchGame(i, name, sizeof(name)) < 0){
+            solution = -1;
+            n = 0;
+        } else if (FrontierCounting){ //The count can be bigger than an int
+            n = FrontierCount();
+            solution = (n > 1)?(2):((int)n);
+            free(Points);
+        } else if (EstimateProbes){ //The estimate and its error take the places of the paths tried out and cut off
+            ReserveBuffers();
+            PrepareGame();
+            estimate = EstimateTree(EstimateProbes, &error);
+            TriedOutPaths = (estimate < 1.8e19)?(estimate + 0.5):(-1ULL);
+            CutOffPaths = (error < 1.8e19)?(error + 0.5):(-1ULL);
+            result = "estimate";
+            solution = n = 0;
+            ReleaseGame();
+        } else {
+            ReserveBuffers();
+            PrepareGame();
+            solution = Solve(1, &limit);
+            n = (solution < 0)?(0):(solution);
+            ReleaseGame();
+        }
+        gettimeofday(&end, NULL);
+        if (result == NULL)
+            result = ResultNames[Result(solution)];
+        pthread_mutex_lock(&PrintLock);
+        printf("%s\t%s\t%s\t%llu\t%.6f\t%llu\n", name, result, CountString(n, count), TriedOutPaths,
+        (end.tv_sec + (double)end.tv_usec/1e6) - (start.tv_sec + (double)start.tv_usec/1e6), CutOffPaths);
+        pthread_mutex_unlock(&PrintLock);
+    }
+    ReleaseBuffers();
+    return NULL;
+}
+
+int SolveBatch(int argc, char *argv[]){
+    pthread_t *pool;
+    Options options;
+    int i;
+    ReadBatchArguments(argc, argv);
+    Draw = 0;
+    SaveOptions(&options);
+    if ((pool = malloc(Threads*sizeof(pthread_t))) == NULL){
+        fprintf(stderr, "Error allocating memory\n");
+        abort();
+    }
+    for (i = 0; i < Threads; i++){
+        if (pthread_create(&pool[i], NULL, BatchMain, &options)){
+            fprintf(stderr, "Error creating the threads\n");
+            abort();
+        }
+    }
+    for (i = 0; i < Threads; i++)
+        pthread_join(pool[i], NULL);
+    free(pool);
+#ifdef STATISTICS
+    if (StatsOutput)
+        PrintStatistics(stderr); //The totals of every game, stdout has only the lines of the games
+#endif
+    FreeBatchFiles();
+    return 0;
+}
+
+void WriteLE(FILE *F, unsigned long long n, int bytes){ //Writes a little endian number
+    for (; bytes > 0; bytes--, n >>= 8)
+        fputc(n & 0xFF, F);
+}
+
+int MakeCorpus(const char *corpus, int argc, char *argv[]){ //Packs the games of the list, as for the batch mode, in a corpus
+    //The index is written at the end, when the offsets of the games are known; the games which are not valid or
+    //don't fit in the corpus are left out, so the number of games too is written at the end
+    FILE *F;
+    unsigned long long *offsets;
+    char name[4096];
+    int i, x, len, games = 0;
+    ReadBatchArguments(argc, argv);
+    if (((F = fopen(corpus, "wb")) == NULL) || ((offsets = malloc((BatchGames + 1)*sizeof(unsigned long long))) == NULL)){
+        fprintf(stderr, "Error writing the corpus %s\n", corpus);
+        abort();
+    }
+    fseek(F, CORPUS_HEADER + 8*(long)BatchGames, SEEK_SET);
+    for (i = 0; i < BatchGames; i++){
+        if (LoadBatchGame(i, name, sizeof(name)) < 0){
+            fprintf(stderr, "The game %s is left out\n", name);
+            continue;
+        }
+        if ((Width > 255) || (Height > 255)){
+            fprintf(stderr, "The game %s is left out, the games of a corpus are at most 255x255\n", name);
+            free(Points);
+            continue;
+        }
+        offsets[games++] = ftell(F);
+        len = strlen(name);
+        fputc(Width, F);
+        fputc(Height, F);
+        fputc(Points_Len, F);
+        WriteLE(F, len, 2);
+        fwrite(name, 1, len, F);
+        for (x = 0; x < Points_Len; x++){
+            fputc(Points[x].x_start, F);
+            fputc(Points[x].y_start, F);
+            fputc(Points[x].x_end, F);
+            fputc(Points[x].y_end, F);
+        }
+        free(Points);
+    }
+    rewind(F);
+    fwrite(CORPUS_MAGIC, 1, 8, F);
+    WriteLE(F, CORPUS_VERSION, 4);
+    WriteLE(F, games, 4);
+    for (i = 0; i < games; i++)
+        WriteLE(F, offsets[i], 8);
+    for (; i < BatchGames; i++) //The room of the games left out
+        WriteLE(F, 0, 8);
+    if (fclose(F) != 0){
+        fprintf(stderr, "Error writing the corpus %s\n", corpus);
+        abort();
+    }
+    printf("%s\t%d games\n", corpus, games);
+    free(offsets);
+    FreeBatchFiles();
+    return 0;
+}
+
+/*
+*  Generator
+*  Makes games with only one solution. A random path that visits every cell of the grid is built from a simple one
+*  with backbite moves (one end of the path is linked to one of its neighbours in the grid and the piece between them
+*  is reversed), then it is cut in the pieces that become the paths of the game, so the game has at least that
+*  solution. A piece with two cells next to each other which are not linked can often take a shortcut, so those
+*  pieces are cut first. Each cut adds a path, so two pieces that follow each other and don't touch themselves once
+*  joined are joined, and the number of paths doesn't change. The solver, stopped at the second solution, checks if
+*  the game has only one: if not, a path is cut in the same way where the other solution differs from the first one,
+*  so the other solution is not valid any more. After a few repairs the game is thrown away and a new one is made.
+*  Each thread of the pool makes a game at a time, and every game depends only on its seed and on the options.
+*/
+#define GENERATOR_REPAIRS 8 //Repairs of a game before it is thrown away
+#define GENERATOR_CANDIDATES 10000 //Games made for a seed before giving up, some sizes have no games with one solution
+
+int GeneratorWidth, GeneratorHeight, GeneratorPaths = 0; //Size of the games, 0 paths means one for each 5 cells
+unsigned long long GeneratorSeed = 1; //Seed of the first game
+int GeneratorGames = 1, GeneratorNext = 0; //Number of games to make, next one to make
+const char *GeneratorDirectory = "."; //Where the games are written
+
+struct _Covering { //A path through every cell of the grid, cut in pieces
+    int *Order; //Cells in the order of the path
+    int *Position; //Index of each cell in Order
+    int *Bounds; //Index in Order of the first cell of each piece, and then the number of cells
+    int *Piece; //ID of the path of each piece, starting from 1
+    int Pieces;
+    Cell *Grid; //The solution made by the pieces
+};
+typedef struct _Covering Covering;
+
+int CompareInts(const void *a, const void *b){
+    return *(const int *)a - *(const int *)b;
+}
+
+int SameGrid(const Cell *a, const Cell *b){ //Checks if two solutions are the same
+    int i;
+    for (i = 0; i < Width*Height; i++)
+        if ((a[i].Path != b[i].Path) || (a[i].Links != b[i].Links))
+            return 0;
+    return 1;
+}
+
+void Backbite(Covering *c, unsigned long long *state){ //Moves one end of the path to one of its neighbours
+    int n = Width*Height, tail = RandomKey(state) & 1, end = c->Order[tail?(n - 1):(0)], x = end % Width, y = end / Width,
+    m = RandomKey(state) % 4, i, j, k, tmp;
+    if ((x + MoveX[m] < 0) || (x + MoveX[m] >= Width) || (y + MoveY[m] < 0) || (y + MoveY[m] >= Height))
+        return;
+    k = c->Position[end + MoveX[m] + MoveY[m]*Width];
+    if (tail){ //The end is linked to the cell k, the piece after k is reversed
+        if (k == n - 2)
+            return;
+        i = k + 1;
+        j = n - 1;
+    } else {
+        if (k == 1)
+            return;
+        i = 0;
+        j = k - 1;
+    }
+    for (; i < j; i++, j--){
+        tmp = c->Order[i];
+        c->Order[i] = c->Order[j];
+        c->Order[j] = tmp;
+        c->Position[c->Order[i]] = i;
+        c->Position[c->Order[j]] = j;
+    }
+}
+
+void CutCovering(Covering *c, unsigned long long *state){ //Cuts the path in pieces of at least 2 cells
+    int n = Width*Height, range = n - c->Pieces - 1, i, j, tmp, *bars = c->Position + n; //Position has room for them
+    //Stars and bars: Pieces - 1 different bars out of range places give the extra cells of each piece
+    for (i = 0; i < range; i++)
+        bars[i] = i;
+    for (i = 0; i < c->Pieces - 1; i++){
+        j = i + RandomKey(state) % (range - i);
+        tmp = bars[i];
+        bars[i] = bars[j];
+        bars[j] = tmp;
+    }
+    qsort(bars, c->Pieces - 1, sizeof(int), CompareInts);
+    c->Bounds[0] = 0;
+    for (i = 1; i < c->Pieces; i++)
+        c->Bounds[i] = bars[i - 1] - (i - 1) + 2*i;
+    c->Bounds[c->Pieces] = n;
+}
+
+void CoveringGame(Covering *c, unsigned long long *state){ //Makes the game of the pieces, with the paths in random order
+    int i, j, tmp, first, last;
+    Cell *g = c->Grid;
+    for (i = 0; i < c->Pieces; i++)
+        c->Piece[i] = i + 1;
+    for (i = c->Pieces - 1; i > 0; i--){
+        j = RandomKey(state) % (i + 1);
+        tmp = c->Piece[i];
+        c->Piece[i] = c->Piece[j];
+        c->Piece[j] = tmp;
+    }
+    Points_Len = c->Pieces;
+    if ((Points = malloc(Points_Len*sizeof(PathPoint))) == NULL){
+        fprintf(stderr, "Error allocating memory\n");
+        abort();
+    }
+    for (i = 0; i < c->Pieces; i++){
+        first = c->Order[c->Bounds[i]];
+        last = c->Order[c->Bounds[i + 1] - 1];
+        if (RandomKey(state) & 1){ //Each path can start from either end
+            tmp = first;
+            first = last;
+            last = tmp;
+        }
+        Points[c->Piece[i] - 1].x_start = first % Width;
+        Points[c->Piece[i] - 1].y_start = first / Width;
+        Points[c->Piece[i] - 1].x_end = last % Width;
+        Points[c->Piece[i] - 1].y_end = last / Width;
+        for (j = c->Bounds[i]; j < c->Bounds[i + 1]; j++){
+            g[c->Order[j]].Path = c->Piece[i];
+            g[c->Order[j]].Links = 0;
+        }
+        for (j = c->Bounds[i]; j + 1 < c->Bounds[i + 1]; j++){
+            tmp = c->Order[j + 1] - c->Order[j];
+            g[c->Order[j]].Links |= (tmp == 1)?(DIR_RIGHT):((tmp == -1)?(DIR_LEFT):((tmp > 0)?(DIR_DOWN):(DIR_UP)));
+            g[c->Order[j + 1]].Links |= (tmp == 1)?(DIR_LEFT):((tmp == -1)?(DIR_RIGHT):((tmp > 0)?(DIR_UP):(DIR_DOWN)));
+        }
+    }
+}
+
+int TouchesItself(Covering *c, int first, int end){ //Checks if two cells of the piece not linked to each other are adjacent
+    int k, m, cell, x, y, n;
+    for (k = first; k < end; k++){
+        cell = c->Order[k];
+        x = cell % Width;
+        y = cell / Width;
+        for (m = 0; m < 4; m++){
+            if ((x + MoveX[m] < 0) || (x + MoveX[m] >= Width) || (y + MoveY[m] < 0) || (y + MoveY[m] >= Height))
+                continue;
+            n = c->Position[cell + MoveX[m] + MoveY[m]*Width];
+            if ((n >= first) && (n < end) && (n > k + 1))
+                return 1;
+        }
+    }
+    return 0;
+}
+
+void CutAndJoin(Covering *c, int cut, unsigned long long *state){ //Cuts the piece after the index cut and joins two others
+    int i, p, found, join;
+    for (p = c->Pieces; c->Bounds[p] > cut + 1; p--) //The bound is added after the cut
+        c->Bounds[p + 1] = c->Bounds[p];
+    c->Bounds[p + 1] = cut + 1;
+    c->Pieces++;
+    //A bound chosen at random is removed, if possible joining two pieces which don't touch themselves
+    for (found = 0, join = -1, i = 1; i < c->Pieces; i++)
+        if ((i != p + 1) && !TouchesItself(c, c->Bounds[i - 1], c->Bounds[i + 1]) && (RandomKey(state) % ++found == 0))
+            join = i;
+    if (join < 0){
+        do {
+            join = 1 + RandomKey(state) % (c->Pieces - 1);
+        } while (join == p + 1);
+    }
+    for (; join < c->Pieces; join++)
+        c->Bounds[join] = c->Bounds[join + 1];
+    c->Pieces--;
+}
+
+int RepairCovering(Covering *c, Cell *other, unsigned long long *state){ //Cuts a piece where the other solution differs, returns 0 if it can't
+    int n = Width*Height, i, p, k, cut = -1, found = 0;
+    if (c->Pieces < 2)
+        return 0;
+    for (i = 0; i < n; i++){ //A random cell, among the ones that differ and can be cut, is chosen
+        if ((other[i].Path == c->Grid[i].Path) && (other[i].Links == c->Grid[i].Links))
+            continue;
+        k = c->Position[i];
+        for (p = 0; c->Bounds[p + 1] <= k; p++){}
+        if ((k - c->Bounds[p] < 1) || (c->Bounds[p + 1] - k < 3))
+            continue; //The pieces would be shorter than 2 cells
+        if (RandomKey(state) % ++found == 0)
+            cut = k;
+    }
+    if (cut < 0)
+        return 0;
+    CutAndJoin(c, cut, state);
+    return 1;
+}
+
+void SmoothCovering(Covering *c, unsigned long long *state){ //Cuts the pieces which touch themselves, while it can
+    int p, k, round, found, piece;
+    if (c->Pieces < 2)
+        return;
+    for (round = 0; round < c->Pieces; round++){
+        for (found = 0, piece = -1, p = 0; p < c->Pieces; p++)
+            if ((c->Bounds[p + 1] - c->Bounds[p] >= 4) && TouchesItself(c, c->Bounds[p], c->Bounds[p + 1]) &&
+            (RandomKey(state) % ++found == 0))
+                piece = p;
+        if (piece < 0)
+            return;
+        k = c->Bounds[piece] + 1 + RandomKey(state) % (c->Bounds[piece + 1] - c->Bounds[piece] - 3);
+        CutAndJoin(c, k, state);
+    }
+}
+
+void WriteGame(const char *name){
+    FILE *F;
+    int i;
+    if ((F = fopen(name, "w")) == NULL){
+        fprintf(stderr, "Error writing the file %s\n", name);
+        abort();
+    }
+    fprintf(F, "%d %d\n%d\n", Width, Height, Points_Len);
+    for (i = 0; i < Points_Len; i++)
+        fprintf(F, "%d\t%d\t%d\t%d\n", Points[i].x_start, Points[i].y_start, Points[i].x_end, Points[i].y_end);
+    fclose(F);
+}
+
+void *GeneratorMain(void *arg){ //arg are the options of the checks
+    Covering c;
+    Cell *kept;
+    Limit limit;
+    unsigned long long seed, state;
+    int game, n, i, repairs, candidates, solution, other;
+    char name[4096];
+    struct timeval start, end;
+    LoadOptions(arg);
+    Width = GeneratorWidth;
+    Height = GeneratorHeight;
+    n = Width*Height;
+    c.Pieces = GeneratorPaths;
+    if (((c.Order = malloc(n*sizeof(int))) == NULL) || ((c.Position = malloc(2*n*sizeof(int))) == NULL) ||
+    ((c.Bounds = malloc((c.Pieces + 2)*sizeof(int))) == NULL) || ((c.Piece = malloc((c.Pieces + 1)*sizeof(int))) == NULL) ||
+    ((c.Grid = malloc(n*sizeof(Cell))) == NULL) || ((kept = malloc(2*n*sizeof(Cell))) == NULL)){
+        fprintf(stderr, "Error allocating memory\n");
+        abort();
+    }
+    KeptSolutions = kept;
+    KeptSolutions_Size = 2;
+    while ((game = __sync_fetch_and_add(&GeneratorNext, 1)) < GeneratorGames){
+        gettimeofday(&start, NULL);
+        seed = GeneratorSeed + game;
+        state = seed*0x9E3779B97F4A7C15ULL + 1; //xorshift needs a state different from 0
+        for (i = 0; i < n; i++){ //The path goes back and forth through the rows
+            c.Order[i] = ((i / Width) % 2)?((i / Width)*Width + Width - 1 - i % Width):(i);
+            c.Position[c.Order[i]] = i;
+        }
+        for (candidates = 1, repairs = 0, solution = 0; candidates <= GENERATOR_CANDIDATES; candidates++){
+            for (i = 0; i < n*n/4 + 1000; i++)
+                Backbite(&c, &state);
+            c.Pieces = GeneratorPaths;
+            CutCovering(&c, &state);
+            SmoothCovering(&c, &state);
+            for (i = 0; ; i++, repairs++){
+                CoveringGame(&c, &state);
+                ReserveBuffers();
+                PrepareGame();
+                KeptSolutions_Len = 0;
+                limit.Found = limit.Stopped = 0;
+                solution = Solve(1, &limit);
+                if (solution == 1)
+                    break;
+                ReleaseGame();
+                //The solution which is not the one of the pieces is used to repair the game
+                other = (KeptSolutions_Len < 2)?(-1):((SameGrid(kept, c.Grid))?(1):(0));
+                if ((solution < 2) || (other < 0) || (i == GENERATOR_REPAIRS) ||
+                !RepairCovering(&c, &kept[other*n], &state))
+                    break; //A new path through the cells is made
+            }
+            if (solution == 1)
+                break;
+        }
+        if (solution != 1){
+            fprintf(stderr, "Error: no game with only one solution was found with the seed %llu\n", seed);
+            continue;
+        }
+        sprintf(name, "%s/%02dx%02d-p%03d-%llu.dat", GeneratorDirectory, Width, Height, Points_Len, seed);
+        WriteGame(name);
+        ReleaseGame();
+        gettimeofday(&end, NULL);
+        pthread_mutex_lock(&PrintLock);
+        printf("%s\t%d\t%d\t%.6f\n", name, candidates, repairs,
+        (end.tv_sec + (double)end.tv_usec/1e6) - (start.tv_sec + (double)start.tv_usec/1e6));
+        fflush(stdout);
+        pthread_mutex_unlock(&PrintLock);
+    }
+    KeptSolutions = NULL;
+    ReleaseBuffers();
+    free(kept);
+    free(c.Grid);
+    free(c.Piece);
+    free(c.Bounds);
+    free(c.Position);
+    free(c.Order);
+    return NULL;
+}
+
+int Generate(){ //Makes GeneratorGames games with a pool of threads
+    pthread_t *pool;
+    Options options;
+    int i;
+    if ((GeneratorWidth < 1) || (GeneratorHeight < 1) || (GeneratorWidth*GeneratorHeight < 2)){
+        fprintf(stderr, "Error: the grid must have at least 2 cells\n");
+        abort();
+    }
+    if (GeneratorPaths == 0)
+        GeneratorPaths = (GeneratorWidth*GeneratorHeight + 4)/5;
+    if ((GeneratorPaths < 1) || (GeneratorPaths > MAX_PATHS) || (2*GeneratorPaths > GeneratorWidth*GeneratorHeight)){
+        fprintf(stderr, "Error: the game can have from 1 to %d paths, each one of at least 2 cells\n", MAX_PATHS);
+        abort();
+    }
+    Draw = 0;
+    SolutionLimit = 2; //Only the uniqueness is checked
+    UseSymmetry = 0; //The other solution is needed to repair the game, even if it is an image of the first one
+    SaveOptions(&options);
+    if ((pool = malloc(Threads*sizeof(pthread_t))) == NULL){
+        fprintf(stderr, "Error allocating memory\n");
+        abort();
+    }
+    for (i = 0; i < Threads; i++){
+        if (pthread_create(&pool[i], NULL, GeneratorMain, &options)){
+            fprintf(stderr, "Error creating the threads\n");
+            abort();
+        }
+    }
+    for (i = 0; i < Threads; i++)
+        pthread_join(pool[i], NULL);
+    free(pool);
+    return 0;
+}
+
+/*
+*  Library
+*  A solver keeps its own copy of the game and of the options (see FollowMe.h). FollowMeSolve loads them in the
+*  variables of the thread which calls it, as a thread of the batch mode does, so the solvers running in different
+*  threads don't share anything. The solutions are passed to the callback by LibrarySolution, one at a time.
+*/
+struct _FollowMeSolver {
+    PathPoint *Points; //The game, NULL if none was loaded
+    int Width, Height, Points_Len;
+    FollowMeOptions Options;
+    FollowMeCallback Callback;
+    void *CallbackData;
+    FollowMeCell *Cells; //The solution passed to the callback
+    int Passed; //Solutions passed to the callback
+    pthread_mutex_t Lock; //Only one thread at a time calls the callback
+    Limit Limit; //Counter of the search running, FollowMeCancel stops it
+    volatile int Cancelled;
+};
+
+void FollowMeDefaultOptions(FollowMeOptions *options){
+    options->Threads = 1;
+    options->SplitDepth = 8;
+    options->Constrained = 0;
+    options->TableMB = 0;
+    options->ReplaceAlways = 0;
+    options->SolutionLimit = 0;
+    options->Symmetry = 1;
+    options->Bidirectional = 1;
+    options->NoSelfTouch = 0;
+    options->Regions = 1;
+}
+
+FollowMeSolver *FollowMeCreate(const FollowMeOptions *options){
+    FollowMeSolver *s;
+    if ((s = calloc(1, sizeof(FollowMeSolver))) == NULL){
+        fprintf(stderr, "Error allocating memory\n");
+        abort();
+    }
+    if (options != NULL)
+        s->Options = *options;
+    else
+        FollowMeDefaultOptions(&(s->Options));
+    pthread_mutex_init(&(s->Lock), NULL);
+    return s;
+}
+
+void FollowMeDestroy(FollowMeSolver *s){
+    if (s == NULL)
+        return;
+    pthread_mutex_destroy(&(s->Lock));
+    free(s->Cells);
+    free(s->Points);
+    free(s);
+}
+
+void KeepGame(FollowMeSolver *s){ //Moves the game of this thread in the solver
+    free(s->Points);
+    s->Points = Points;
+    s->Width = Width;
+    s->Height = Height;
+    s->Points_Len = Points_Len;
+    Points = NULL;
+    free(s->Cells);
+    if ((s->Cells = malloc(Width*Height*sizeof(FollowMeCell))) == NULL){
+        fprintf(stderr, "Error allocating memory\n");
+        abort();
+    }
+}
+
+int FollowMeLoad(FollowMeSolver *s, const char *file){
+    if (ReadGame(file) < 0)
+        return -1;
+    KeepGame(s);
+    return 0;
+}
+
+int FollowMeSetGame(FollowMeSolver *s, int width, int height, int paths, const unsigned *endpoints){
+    int i;
+    if ((width < 1) || (height < 1) || (paths < 0) || (paths > MAX_PATHS)){
+        fprintf(stderr, "Error: the grid must have at least one cell and the game at most %d paths\n", MAX_PATHS);
+        return -1;
+    }
+    Width = width;
+    Height = height;
+    Points_Len = paths;
+    if ((Points = malloc((paths + 1)*sizeof(PathPoint))) == NULL){
+        fprintf(stderr, "Error allocating memory\n");
+        abort();
+    }
+    for (i = 0; i < paths; i++){
+        Points[i].x_start = endpoints[4*i];
+        Points[i].y_start = endpoints[4*i + 1];
+        Points[i].x_end = endpoints[4*i + 2];
+        Points[i].y_end = endpoints[4*i + 3];
+    }
+    if (CheckPoints() < Points_Len){
+        free(Points);
+        return -1;
+    }
+    KeepGame(s);
+    return 0;
+}
+
+void FollowMeSetCallback(FollowMeSolver *s, FollowMeCallback callback, void *data){
+    s->Callback = callback;
+    s->CallbackData = data;
+}
+
+void FollowMeCancel(FollowMeSolver *s){
+    s->Cancelled = 1;
+    s->Limit.Stopped = 1;
+}
+
+void LibrarySolution(const Cell *grid, void *data){ //Passes a solution found by a thread of the solver to its callback
+    FollowMeSolver *s = data;
+    int i;
+    pthread_mutex_lock(&(s->Lock));
+    //The threads can find some solutions more than the limit before they stop
+    if (!s->Cancelled && (!SolutionLimit || (s->Passed < SolutionLimit))){
+        for (i = 0; i < Width*Height; i++){
+            s->Cells[i].Path = grid[i].Path;
+            s->Cells[i].Links = grid[i].Links; //DIR_LEFT... are the same as FOLLOWME_LEFT...
+        }
+        s->Passed++;
+        if (s->Callback(s->Cells, Width, Height, s->CallbackData))
+            FollowMeCancel(s);
+    }
+    pthread_mutex_unlock(&(s->Lock));
+}
+
+int FollowMeSolve(FollowMeSolver *s, FollowMeResult *result){
+    long long solution;
+    int threads = s->Options.Threads;
+    if (threads <= 0)
+        threads = sysconf(_SC_NPROCESSORS_ONLN);
+    if (threads <= 0)
+        threads = 1;
+    //Cancelled and Stopped are cleared when a search ends, so a cancel which comes before this one starts still stops it
+    s->Passed = 0;
+    s->Limit.Found = 0;
+    result->TriedOutPaths = result->CutOffPaths = 0;
+    if (s->Points == NULL){
+        result->Solutions = 0;
+        s->Cancelled = s->Limit.Stopped = 0;
+        return result->Result = FOLLOWME_ERROR;
+    }
+    Draw = 0;
+    Constrained = s->Options.Constrained;
+    SolutionLimit = s->Options.SolutionLimit;
+    SplitDepth = s->Options.SplitDepth;
+    TableMB = s->Options.TableMB;
+    ReplaceAlways = s->Options.ReplaceAlways;
+    UseSymmetry = s->Options.Symmetry;
+    Bidirectional = s->Options.Bidirectional;
+    NoSelfTouch = s->Options.NoSelfTouch;
+    SplitRegions = s->Options.Regions;
+    OnSolution = (s->Callback != NULL)?(LibrarySolution):(NULL);
+    OnSolutionData = s;
+    Width = s->Width;
+    Height = s->Height;
+    Points_Len = s->Points_Len;
+    if ((Points = malloc((Points_Len + 1)*sizeof(PathPoint))) == NULL){ //ReleaseGame frees it
+        fprintf(stderr, "Error allocating memory\n");
+        abort();
+    }
+    memcpy(Points, s->Points, Points_Len*sizeof(PathPoint));
+    TriedOutPaths = CutOffPaths = 0;
+    AllocBuffers();
+    PrepareGame();
+    solution = Solve(threads, &(s->Limit));
+    ReleaseGame();
+    FreeBuffers();
+    OnSolution = NULL;
+    result->Solutions = (solution < 0)?(0):(solution);
+    result->TriedOutPaths = TriedOutPaths;
+    result->CutOffPaths = CutOffPaths;
+    result->Result = (s->Cancelled && (solution >= 0))?(FOLLOWME_CANCELLED):(Result(solution));
+    s->Cancelled = s->Limit.Stopped = 0;
+    return result->Result;
+}
+
+#ifndef FOLLOWME_LIBRARY
+int main(int argc, char * argv[]){
+    long long solutionsfound;
+    int opt, batch = 0, generate = 0;
+    const char *corpus = NULL;
+    char count[40];
+    double estimate, error;
+    Count n;
+    struct timeval start, end;
+    Limit limit = {0, 0};
+    gettimeofday(&start, NULL);
+    //Options: -j N solves the game with N threads (0 means one for each processor),
+    //         -d N sets the depth up to which the search tree is split in tasks,
+    //         -c extends first the path with the fewest moves instead of drawing the paths in order,
+    //         -a searches every solution, without counting the images of the symmetric ones (see Symmetries),
+    //         -u extends the paths only from their start endpoints (see Bidirectional search),
+    //         -x counts only the solutions where no path runs next to itself (see Self touch),
+    //         -o searches the whole grid at once, without solving apart the regions (see Independent regions),
+    //         -f counts the solutions without searching them (see Frontier counting),
+    //         -z N estimates the paths the search would try out with N random probes, without searching (see Estimate),
+    //         -t N stores the solutions of the subtrees in a transposition table of N MB,
+    //         -r always|bigger sets which entry of the table is replaced by a new one,
+    //         -b solves in batch mode the games of the files and directories passed (see SolveBatch),
+    //         -m file packs the games of the files and directories passed in a corpus (see Corpus),
+    //         -s table|json prints the statistics of the search (see Statistics),
+    //         -n N stops the search after N solutions (see Solution limit),
+    //         -q doesn't draw the grid, only the result is printed,
+    //         -w file saves the search in the file and resumes it if the file exists, -i N every N seconds (see Checkpoints),
+    //         -v N prints the progress of the search every N seconds (see Progress),
+    //         -g WxH makes games of that size with only one solution (see Generator),
+    //         -p N sets the number of paths of the games made, -e N the seed of the first one, -k N how many to make
+    while ((opt = getopt(argc, argv, "j:d:cauxofz:t:r:bm:s:n:qw:i:v:g:p:e:k:")) != -1){
+        switch (opt){
+            case 'j':
+                Threads = atoi(optarg);
+                if (Threads <= 0)
+                    Threads = sysconf(_SC_NPROCESSORS_ONLN);
+                if (Threads <= 0)
+                    Threads = 1;
+                break;
+            case 'd':
+                SplitDepth = atoi(optarg);
+                break;
+            case 'c':
+                Constrained = 1;
+                break;
+            case 'a':
+                UseSymmetry = 0;
+                break;
+            case 'u':
+                Bidirectional = 0;
+                break;
+            case 'x':
+                NoSelfTouch = 1;
+                break;
+            case 'o':
+                SplitRegions = 0;
+                break;
+            case 'f':
+                FrontierCounting = 1;
+                break;
+            case 'z':
+                if ((EstimateProbes = atoi(optarg)) <= 0){
+                    fprintf(stderr, "Error: the probes of the estimate must be 1 or more\n");
+                    abort();
+                }
+                break;
+            case 't':
+                TableMB = atoi(optarg);
+                break;
+            case 'r':
+                if (!strcmp(optarg, "always"))
+                    ReplaceAlways = 1;
+                else if (!strcmp(optarg, "bigger"))
+                    ReplaceAlways = 0;
+                else {
+                    fprintf(stderr, "Error: unknown replacement policy %s\nIt must be always or bigger\n", optarg);
+                    abort();
+                }
+                break;
+            case 'b':
+                batch = 1;
+                break;
+            case 'm':
+                corpus = optarg;
+                break;
+            case 'q':
+                Draw = 0;
+                break;
+            case 'w':
+                CheckpointFile = optarg;
+                break;
+            case 'i':
+                if ((CheckpointInterval = atoi(optarg)) <= 0){
+                    fprintf(stderr, "Error: the seconds between two checkpoints must be 1 or more\n");
+                    abort();
+                }
+                break;
+            case 'v':
+                if ((ProgressInterval = atoi(optarg)) <= 0){
+                    fprintf(stderr, "Error: the seconds between two lines of the progress must be 1 or more\n");
+                    abort();
+                }
+                break;
+            case 'g':
+                if (sscanf(optarg, "%dx%d", &GeneratorWidth, &GeneratorHeight) != 2){
+                    fprintf(stderr, "Error: the size of the games must be in the form WIDTHxHEIGHT\n");
+                    abort();
+                }
+                generate = 1;
+                break;
+            case 'p':
+                GeneratorPaths = atoi(optarg);
+                break;
+            case 'e':
+                GeneratorSeed = strtoull(optarg, NULL, 10);
+                break;
+            case 'k':
+                GeneratorGames = atoi(optarg);
+                break;
+            case 'n':
+                if ((SolutionLimit = atoi(optarg)) < 0){
+                    fprintf(stderr, "Error: the limit of the solutions must be 0 (no limit) or more\n");
+                    abort();
+                }
+                break;
+            case 's':
+#ifndef STATISTICS
+                fprintf(stderr, "Error: the statistics are not available\nDefine STATISTICS in FollowMe.c to keep them\n");
+                abort();
+#endif
+                if (!strcmp(optarg, "table"))
+                    StatsOutput = STATS_TABLE;
+                else if (!strcmp(optarg, "json"))
+                    StatsOutput = STATS_JSON;
+                else {
+                    fprintf(stderr, "Error: unknown statistics format %s\nIt must be table or json\n", optarg);
+                    abort();
+                }
+                break;
+            default:
+                fprintf(stderr, "Usage: %s [-j threads] [-d split depth] [-c] [-a] [-u] [-x] [-o] [-f] [-z probes] [-t table MB] [-r always|bigger] [-s table|json] [-n limit] [-q] [-w checkpoint file] [-i seconds] [-v seconds] game_data_file\n"
+                "       %s -b [-j threads] [options] [files or directories, - for stdin]\n"
+                "       %s -m corpus.fmc [files or directories, - for stdin]\n"
+                "       %s -g WIDTHxHEIGHT [-p paths] [-e seed] [-k games] [-j threads] [options] [directory]\n",
+                argv[0], argv[0], argv[0], argv[0]);
+                abort();
+        }
+    }
+    if ((CheckpointFile != NULL) && (batch || generate || (corpus != NULL) || (Threads > 1))){
+        fprintf(stderr, "Error: only the search of one game with one thread can be saved in a checkpoint\n");
+        abort();
+    }
+    if (FrontierCounting && (generate || SolutionLimit || NoSelfTouch || (CheckpointFile != NULL) || StatsOutput)){
+        fprintf(stderr, "Error: the frontier counting finds only the number of every solution\nIt can't be used with -g, -n, -x, -w or -s\n");
+        abort();
+    }
+    if (ProgressInterval && (batch || generate || (corpus != NULL) || (Threads > 1) || EstimateProbes || FrontierCounting)){
+        fprintf(stderr, "Error: only the search of one game with one thread can print its progress\n");
+        abort();
+    }
+    if (EstimateProbes && (generate || FrontierCounting || (CheckpointFile != NULL) || StatsOutput)){
+        fprintf(stderr, "Error: the estimate only makes random probes of the tree\nIt can't be used with -g, -f, -w or -s\n");
+        abort();
+    }
+    if (CheckpointFile != NULL)
+        SplitRegions = 0; //The searches of the regions are not saved in the checkpoints
+    if (corpus != NULL)
+        return MakeCorpus(corpus, argc - optind, argv + optind);
+    if (batch) //In batch mode the threads solve different games
+        return SolveBatch(argc - optind, argv + optind);
+    if (generate){ //The games are written in the directory passed, the current one if there's none
+        if (optind < argc)
+            GeneratorDirectory = argv[optind];
+        return Generate();
+    }
+    //chek that the user passed at least one argument
+    if (optind >= argc){
+        fprintf(stderr, "Error, insufficient args\nYou have to pass at least the game data file\n");
+        abort();
+    }
+    if (ReadGame(argv[optind]) < 0) //the first argument should be the file containing the game data
+        abort();
+    if (FrontierCounting){ //Nothing is drawn, the solutions are not searched
+        n = FrontierCount();
+        gettimeofday(&end, NULL);
+        printf(".----------.\n| Success! |   Time taken: %.6f seconds\n'----------'   Counted with at most %zu frontiers at a time\n", ((end.tv_sec + (double)end.tv_usec/1e6) - (start.tv_sec + (double)start.tv_usec/1e6)), FrontierStates);
+        if (n == 0)
+            printf("Were found no solutions :(\n");
+        else if (n == 1)
+            printf("Were found only one solution :)\n");
+        else
+            printf("Were found %s solutions :)\n", CountString(n, count));
+        free(Points);
+        return 0;
+    }
+
+    //Initialiting matrix
+    AllocBuffers();
+    PrepareGame();
+    if (EstimateProbes){ //Nothing is drawn, the solutions are not searched
+        estimate = EstimateTree(EstimateProbes, &error);
+        gettimeofday(&end, NULL);
+        printf(".----------.\n| Success! |   Time taken: %.6f seconds\n'----------'   Estimated with %d probes\n", ((end.tv_sec + (double)end.tv_usec/1e6) - (start.tv_sec + (double)start.tv_usec/1e6)), EstimateProbes);
+        printf("The search would try out about %.3g paths, with a standard error of %.3g\n", estimate, error);
+        ReleaseGame();
+        FreeBuffers();
+        return 0;
+    }
+#ifdef RANDOM_COLOR
+    srand(time(NULL));  //Starts the random generator
+    Randq = rand();
+    Randm = rand();
+    InitColors();
+#endif
+    PrintPoint_x = 1;
+    PrintPoint_y = 1; //Prints the upper left corner of the grid in the point (1; 1)
+    if (CheckpointFile != NULL){ //When the program is stopped the search is saved
+        signal(SIGINT, CheckpointHandler);
+        signal(SIGTERM, CheckpointHandler);
+    }
+    if (Draw){
+        printf("\033[2J"); //Clear the screen
+#ifdef ANIMATION
+        StartAnimation();
+#endif
+    }
+    solutionsfound = Solve(Threads, &limit); //Solves the game
+    if (Draw){
+#ifdef ANIMATION
+        StopAnimation();
+#endif
+        ClearGrid();
+    }
+    if (solutionsfound < 0) {
+        if (solutionsfound == SOLUTIONS_OVERFLOW)
+            fprintf(stderr, "Error: the game has more solutions than the search can count, count them with -f\n");
+        else
+            fprintf(stderr, "Error solving the game\n");
+        ReleaseGame();
+        FreeBuffers();
+        exit(-1);
+    } else {
+        gettimeofday(&end, NULL);
+        printf("\n\n.----------.\n| Success! |   Time taken: %.6f seconds\n'----------'   Tried out %llu paths\n", ((end.tv_sec + (double)end.tv_usec/1e6) - (start.tv_sec + (double)start.tv_usec/1e6)), TriedOutPaths);
+        if (Symmetries_Len > 1)
+            printf("The search used %d symmetries of the game, the images of the solutions were counted without searching them\n", Symmetries_Len - 1);
+        if (SolutionLimit && (solutionsfound == SolutionLimit))
+            printf("The search was stopped: were found at least %lld solution%s\n", solutionsfound, (solutionsfound == 1)?(""):("s"));
+        else if (solutionsfound == 0)
+            printf("Were found no solutions :(\n");
+        else if (solutionsfound == 1)
+            printf("Were found only one solution :)\n");
+        else
+            printf("Were found %lld solutions :)\n", solutionsfound);
+    }
+#ifdef STATISTICS
+    if (StatsOutput){
+        fflush(stdout);
+        PrintStatistics(stderr);
+    }
+#endif
+    ReleaseGame();
+    FreeBuffers();
+    return SolutionLimit?(Result(solutionsfound)):(0); //With a limit the exit code is the result
+}
+#endif
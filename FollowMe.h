@@ -0,0 +1,104 @@
+/*
+*  FollowMe game solver
+*
+*  Copyright (c) 2013	Serraino Alessio
+*
+*  This program is free software; you can redistribute it and/or modify
+*  it under the terms of the GNU General Public License as published by
+*  the Free Software Foundation; either version 2 of the License, or
+*  (at your option) any later version.
+*
+*  This program is distributed in the hope that it will be useful,
+*  but WITHOUT ANY WARRANTY; without even the implied warranty of
+*  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*  GNU General Public License for more details.
+*
+*  You should have received a copy of the GNU General Public License
+*  along with this program; If not, see <http://www.gnu.org/licenses/>.
+*/
+
+/*
+*  FollowMe solver library
+*  FollowMe.c built with -DFOLLOWME_LIBRARY has no main and can be linked in another program. Each game is solved
+*  by a solver: it is created with the options, the game is loaded from a file or passed as the endpoints of its
+*  paths, and then it is solved in the thread which calls FollowMeSolve (and in Threads - 1 more threads started by
+*  it). A solver can solve one game at a time, but different solvers can solve their games at the same time in
+*  different threads, each one with its own options. While a solver is solving, FollowMeCancel can stop it from
+*  any thread; a cancel which comes just before FollowMeSolve starts is not lost, it stops that search.
+*/
+#ifndef FOLLOWME_H
+#define FOLLOWME_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define FOLLOWME_API __attribute__((visibility("default"))) //Only these are exported by the shared library
+
+//Results of a search, the same as the exit codes of FollowMe with -n
+#define FOLLOWME_UNIQUE    0 //Only one solution
+#define FOLLOWME_NONE      1 //No solutions
+#define FOLLOWME_MULTIPLE  2 //More than one solution
+#define FOLLOWME_SOME      3 //At least one, the search was stopped at the first one
+#define FOLLOWME_ERROR     4
+#define FOLLOWME_CANCELLED 5 //The search was stopped by FollowMeCancel or by the callback
+
+//Links of a cell of a solution to the cells next to it
+#define FOLLOWME_LEFT  0x1 //x - 1
+#define FOLLOWME_RIGHT 0x2 //x + 1
+#define FOLLOWME_UP    0x4 //y - 1
+#define FOLLOWME_DOWN  0x8 //y + 1
+
+typedef struct _FollowMeSolver FollowMeSolver;
+
+struct _FollowMeOptions { //The same as the options of FollowMe
+    int Threads; //-j, 1 by default
+    int SplitDepth; //-d, 8 by default
+    int Constrained; //-c, 0 by default
+    int TableMB; //-t, 0 by default
+    int ReplaceAlways; //-r always if 1, 0 by default
+    int SolutionLimit; //-n, 0 by default
+    int Symmetry; //0 as -a, 1 by default
+    int Bidirectional; //0 as -u, 1 by default
+    int NoSelfTouch; //-x, 0 by default
+    int Regions; //0 as -o, 1 by default
+};
+typedef struct _FollowMeOptions FollowMeOptions;
+
+struct _FollowMeCell { //A cell of a solution
+    unsigned char Path; //ID of the path, starting from 1 in the order of the endpoints
+    unsigned char Links; //FOLLOWME_LEFT... of the cells of the same path linked to this one
+};
+typedef struct _FollowMeCell FollowMeCell;
+
+struct _FollowMeResult {
+    int Result; //FOLLOWME_UNIQUE...
+    long long Solutions; //Solutions found, at most SolutionLimit if it is set
+    unsigned long long TriedOutPaths, CutOffPaths;
+};
+typedef struct _FollowMeResult FollowMeResult;
+
+//Called with each solution found, the cells are width*height, row by row, and they are valid only during the call.
+//Only one call at a time is made for each solver, even when more threads solve the game; the solutions counted from
+//the transposition table and the images of the solutions of a symmetric game (unless Symmetry is 0) are not passed.
+//If it returns a value different from 0 the search is stopped. The callback must not use any FollowMe function but
+//FollowMeCancel.
+typedef int (*FollowMeCallback)(const FollowMeCell *cells, int width, int height, void *data);
+
+FOLLOWME_API void FollowMeDefaultOptions(FollowMeOptions *options);
+FOLLOWME_API FollowMeSolver *FollowMeCreate(const FollowMeOptions *options); //NULL for the default options
+FOLLOWME_API void FollowMeDestroy(FollowMeSolver *solver);
+//They return 0, or -1 if the game is not valid (the reason is written on stderr), replacing the game of the solver
+FOLLOWME_API int FollowMeLoad(FollowMeSolver *solver, const char *file);
+FOLLOWME_API int FollowMeSetGame(FollowMeSolver *solver, int width, int height, int paths,
+const unsigned *endpoints); //x_start, y_start, x_end, y_end of each path
+FOLLOWME_API void FollowMeSetCallback(FollowMeSolver *solver, FollowMeCallback callback, void *data);
+FOLLOWME_API int FollowMeSolve(FollowMeSolver *solver, FollowMeResult *result); //Returns result->Result
+//Stops the search running; if none is running yet, the next search of the solver stops as soon as it starts
+FOLLOWME_API void FollowMeCancel(FollowMeSolver *solver);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
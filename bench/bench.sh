@@ -0,0 +1,71 @@
+#!/bin/sh
+#
+#  FollowMe benchmark
+#
+#  Solves every game of the benchmark set with one thread in batch mode, as many times as asked, and prints for
+#  each game the median time of the runs, the paths tried out per second and the rate of the paths cut off by the
+#  pruning (cut off / (tried out + cut off)). The games are sorted by name and the numbers have a fixed format, so
+#  the outputs of two commits can be compared with diff or joined on the first column.
+#
+#  The games of a set never change: when the set has to change a new directory (v2, v3...) is added, and the
+#  version is written in the output.
+#
+#  Usage: bench/bench.sh [-n runs] [-s set] [-x solver] [-- solver options]
+#    -n runs    runs of each game, the median time is taken (default 5)
+#    -s set     directory of the set inside bench (default v1)
+#    -x solver  the FollowMe executable (default FollowMe in the parent directory of bench)
+#  The options after -- are passed to the solver, for example -- -c -t 64
+#
+
+dir=$(cd "$(dirname "$0")" && pwd)
+runs=5
+set=v1
+solver="$dir/../FollowMe"
+while getopts "n:s:x:" opt; do
+    case $opt in
+        n) runs=$OPTARG ;;
+        s) set=$OPTARG ;;
+        x) solver=$OPTARG ;;
+        *) echo "Usage: $0 [-n runs] [-s set] [-x solver] [-- solver options]" >&2; exit 1 ;;
+    esac
+done
+shift $((OPTIND - 1))
+if [ ! -x "$solver" ]; then
+    echo "Error: $solver is not an executable, build it or pass it with -x" >&2
+    exit 1
+fi
+if [ ! -d "$dir/$set" ]; then
+    echo "Error: the set $set does not exist in $dir" >&2
+    exit 1
+fi
+
+results=$(mktemp)
+trap 'rm -f "$results"' EXIT
+#Each line of the batch mode is: file, result, solutions, tried out, seconds, cut off
+run=1
+while [ $run -le "$runs" ]; do
+    "$solver" -b -j 1 "$@" "$dir/$set" >> "$results" || exit 1
+    run=$((run + 1))
+done
+
+echo "# FollowMe benchmark $set, $runs runs, solver options:${*:+ $*}"
+printf "game\tresult\tsolutions\ttried\tcutoff\tmedian_s\ttried_per_s\tcutoff_rate\n"
+#The runs of each game are sorted by time, then the median one is taken
+awk -F '\t' '{ n = split($1, path, "/"); sub(/\.dat$/, "", path[n]); print path[n] "\t" $2 "\t" $3 "\t" $4 "\t" $6 "\t" $5 }' "$results" |
+sort -t "$(printf '\t')" -k1,1 -k6,6g |
+awk -F '\t' -v runs="$runs" '
+    function flush(){
+        if (game == "")
+            return
+        total += median
+        printf "%s\t%s\t%s\t%s\t%s\t%.6f\t%.0f\t%.4f\n", game, result, solutions, tried, cutoff, median,
+        (median > 0)?(tried/median):(0), (tried + cutoff > 0)?(cutoff/(tried + cutoff)):(0)
+    }
+    $1 != game { flush(); game = $1; run = 0 }
+    {
+        run++
+        if (run == int((runs + 1)/2)){
+            result = $2; solutions = $3; tried = $4; cutoff = $5; median = $6
+        }
+    }
+    END { flush(); printf "total\t\t\t\t\t%.6f\t\t\n", total }'
@@ -0,0 +1,60 @@
+#!/bin/sh
+#
+#  FollowMe self touch test
+#
+#  Solves the games of test/selftouch with -x and each order of the search (from the start endpoints with -u, the
+#  most constrained path first with -c, the regions apart or not with -o, with the table), and checks that every
+#  order counts the solutions without self touches written in test/selftouch/expected.txt: the count of -x must not
+#  depend on the order of the moves. The counts were found from every solution of the games, dropping the ones where
+#  two cells of a path are next to each other without being linked.
+#
+#  Usage: test/selftouch.sh [-x solver]
+#    -x solver  the FollowMe executable (default FollowMe in the parent directory of test)
+#
+
+dir=$(cd "$(dirname "$0")" && pwd)
+solver="$dir/../FollowMe"
+while getopts "x:" opt; do
+    case $opt in
+        x) solver=$OPTARG ;;
+        *) echo "Usage: $0 [-x solver]" >&2; exit 1 ;;
+    esac
+done
+if [ ! -x "$solver" ]; then
+    echo "Error: $solver is not an executable, build it or pass it with -x" >&2
+    exit 1
+fi
+
+results=$(mktemp)
+trap 'rm -f "$results"' EXIT
+failed=0
+for options in "" "-u" "-c" "-c -u" "-o" "-u -o" "-c -t 16" "-c -n 2"; do
+    #Each line of the batch mode is: file, result, solutions, tried out, seconds, cut off
+    "$solver" -b -j 1 -x $options "$dir/selftouch" > "$results" || exit 1
+    awk -F '\t' -v options="-x${options:+ $options}" '
+        FNR == NR { expected[$1] = $2; total++; next }
+        {
+            n = split($1, path, "/")
+            sub(/\.dat$/, "", path[n])
+            count = expected[path[n]]
+            if ((options ~ /-n 2/) && (count > 2))
+                count = 2 #The search stops at the second solution
+            if ($3 != count){
+                printf "%s with %s: %s solutions instead of %s\n", path[n], options, $3, count
+                failed = 1
+            }
+            games++
+        }
+        END {
+            if (games != total){
+                printf "%s: %d games solved instead of %d\n", options, games, total
+                failed = 1
+            }
+            exit failed
+        }' "$dir/selftouch/expected.txt" "$results" || failed=1
+done
+if [ $failed -ne 0 ]; then
+    echo "FAILED"
+    exit 1
+fi
+echo "ok"